@@ -0,0 +1,504 @@
+/* generated by tools/generate_tree_table.cpp from default_trees.h, do not edit */
+
+#ifndef INCLUDED_DEFAULT_TREE_TABLE_H
+#define INCLUDED_DEFAULT_TREE_TABLE_H
+
+#include "treeidmap.h"
+
+static const char default_tree_strings[] =
+    "w0122222212212121111\0"
+    "w0122212221222121111\0"
+    "w0122212221221221111\0"
+    "w0122212221212121111\0"
+    "w0122222212221211111\0"
+    "w0122221221221221111\0"
+    "w0122212212212211111\0"
+    "w0122221222122121111\0"
+    "w0122222222212111111\0"
+    "w0122221221212121111\0"
+    "w0122222122221211111\0"
+    "w0122221222122211111\0"
+    "w0122222222222121111\0"
+    "w0122221212121211111\0"
+    "w0122222121212121111\0"
+    "w0122222121212111111\0"
+    "w0122212212212121111\0"
+    "w0122222212222211111\0"
+    "w0122222212212211111\0"
+    "w0122221222121211111\0"
+    "w0122222221221221111\0"
+    "w0122222122222121111\0"
+    "w0122222222212211111\0"
+    "w0122212212121211111\0"
+    "w0122222212222121111\0"
+    "w0122122122121211111\0"
+    "w0122222212121211111\0"
+    "w0122222222122211111\0"
+    "w0122221221221211111\0"
+    "w0122222222222211111\0"
+    "w0122222122212111111\0"
+    "w0122212221212111111\0"
+    "w0122222122122111111\0"
+    "w0122212121212121111\0"
+    "w0122222221212111111\0"
+    "w0122222221221211111\0"
+    "w0122222212222111111\0"
+    "w0122222221222211111\0"
+    "w0122212212212111111\0"
+    "w0122222212221221111\0"
+    "w0122221222122111111\0"
+    "w0122222222122121111\0"
+    "w0122221222212111111\0"
+    "w0122222222122111111\0"
+    "w0122222222222221111\0"
+    "w0122222122212121111\0"
+    "w0122222122122121111\0"
+    "w0122222222121211111\0"
+    "w0122212221221211111\0"
+    "w0121212121212121111\0"
+    "w0122222222212221111\0"
+    "w0122222222221211111\0"
+    "w0122222222121111111\0"
+    "w0122222221222221111\0"
+    "w0122222222222111111\0"
+    "w0122222212212111111\0"
+    "w0122222212222221111\0"
+    "w0122222221212121111\0"
+    "w0122221222212211111\0"
+    "w0122121212121211111\0"
+    "w0122222221222121111\0"
+    "w0122222221222111111\0"
+    "w0122222122221221111\0"
+    "w0122122122122111111\0"
+    "w0122221222212121111\0"
+    "w0122222122212221111\0"
+    "w0122222122212211111\0"
+    "w0122222222221221111\0"
+    "w0122221221221111111\0"
+    "w0122212121212111111\0"
+    "w0122221222212221111\0"
+    "w0122212221221111111\0"
+    "w0122222222122221111\0"
+    "w0122221212121111111\0"
+    "w0122122121212121111\0"
+    "w0121212121212111111\0"
+    "w0122212221222111111\0"
+    "w0122222222221111111\0"
+    "w0122221221212111111\0"
+    "w0122222222212121111\0"
+    "w0122222212221111111\0"
+    "w0122221222211111111\0"
+    "w0122122122122121111\0"
+    "w0122221222121111111\0"
+    "w0122222122121211111\0"
+    "w0122222122211111111\0"
+    "w0122222221221111111\0"
+    "w0122222122222111111\0"
+    "w0122122121212111111\0"
+    "w0122222212211111111\0"
+    "w0122222222211111111\0"
+    "w0122222222111111111\0"
+    "w0122222221211111111\0"
+    "w0122222122221111111\0"
+    "w0122212212121111111\0"
+    "w0122222122121111111\0"
+    "w0122222122111111111\0"
+    "w0122222121211111111\0"
+    "w0122222212121111111\0"
+    "w0122222221111111111\0"
+    "w0122222212111111111\0"
+    "w0122221222111111111\0"
+    "w0122212221211111111\0"
+    "w0122221221211111111\0"
+    "w0122122122121111111\0"
+    "w0122212212211111111\0"
+    "w0122121212121111111\0"
+    "w0122212121211111111\0"
+    "b0122222212212121111\0"
+    "b0122212221222121111\0"
+    "b0122212221221221111\0"
+    "b0122212221212121111\0"
+    "b0122222212221211111\0"
+    "b0122221221221221111\0"
+    "b0122212212212211111\0"
+    "b0122221222122121111\0"
+    "b0122222222212111111\0"
+    "b0122221221212121111\0"
+    "b0122222122221211111\0"
+    "b0122221222122211111\0"
+    "b0122222222222121111\0"
+    "b0122221212121211111\0"
+    "b0122222121212121111\0"
+    "b0122222121212111111\0"
+    "b0122212212212121111\0"
+    "b0122222212222211111\0"
+    "b0122222212212211111\0"
+    "b0122221222121211111\0"
+    "b0122222221221221111\0"
+    "b0122222122222121111\0"
+    "b0122222222212211111\0"
+    "b0122212212121211111\0"
+    "b0122222212222121111\0"
+    "b0122122122121211111\0"
+    "b0122222212121211111\0"
+    "b0122222222122211111\0"
+    "b0122221221221211111\0"
+    "b0122222222222211111\0"
+    "b0122222122212111111\0"
+    "b0122212221212111111\0"
+    "b0122222122122111111\0"
+    "b0122212121212121111\0"
+    "b0122222221212111111\0"
+    "b0122222221221211111\0"
+    "b0122222212222111111\0"
+    "b0122222221222211111\0"
+    "b0122212212212111111\0"
+    "b0122222212221221111\0"
+    "b0122221222122111111\0"
+    "b0122222222122121111\0"
+    "b0122221222212111111\0"
+    "b0122222222122111111\0"
+    "b0122222222222221111\0"
+    "b0122222122212121111\0"
+    "b0122222122122121111\0"
+    "b0122222222121211111\0"
+    "b0122212221221211111\0"
+    "b0121212121212121111\0"
+    "b0122222222212221111\0"
+    "b0122222222221211111\0"
+    "b0122222222121111111\0"
+    "b0122222221222221111\0"
+    "b0122222222222111111\0"
+    "b0122222212212111111\0"
+    "b0122222212222221111\0"
+    "b0122222221212121111\0"
+    "b0122221222212211111\0"
+    "b0122121212121211111\0"
+    "b0122222221222121111\0"
+    "b0122222221222111111\0"
+    "b0122222122221221111\0"
+    "b0122122122122111111\0"
+    "b0122221222212121111\0"
+    "b0122222122212221111\0"
+    "b0122222122212211111\0"
+    "b0122222222221221111\0"
+    "b0122221221221111111\0"
+    "b0122212121212111111\0"
+    "b0122221222212221111\0"
+    "b0122212221221111111\0"
+    "b0122222222122221111\0"
+    "b0122221212121111111\0"
+    "b0122122121212121111\0"
+    "b0121212121212111111\0"
+    "b0122212221222111111\0"
+    "b0122222222221111111\0"
+    "b0122221221212111111\0"
+    "b0122222222212121111\0"
+    "b0122222212221111111\0"
+    "b0122221222211111111\0"
+    "b0122122122122121111\0"
+    "b0122221222121111111\0"
+    "b0122222122121211111\0"
+    "b0122222122211111111\0"
+    "b0122222221221111111\0"
+    "b0122222122222111111\0"
+    "b0122122121212111111\0"
+    "b0122222212211111111\0"
+    "b0122222222211111111\0"
+    "b0122222222111111111\0"
+    "b0122222221211111111\0"
+    "b0122222122221111111\0"
+    "b0122212212121111111\0"
+    "b0122222122121111111\0"
+    "b0122222122111111111\0"
+    "b0122222121211111111\0"
+    "b0122222212121111111\0"
+    "b0122222221111111111\0"
+    "b0122222212111111111\0"
+    "b0122221222111111111\0"
+    "b0122212221211111111\0"
+    "b0122221221211111111\0"
+    "b0122122122121111111\0"
+    "b0122212212211111111\0"
+    "b0122121212121111111\0"
+    "b0122212121211111111\0";
+
+static const TreeTableNode default_tree_nodes[216] = {
+    { 0, 0, 0, 6 },
+    { 21, 1, 6, 4 },
+    { 42, 2, 10, 4 },
+    { 63, 3, 14, 1 },
+    { 84, 4, 15, 1 },
+    { 105, 5, 16, 4 },
+    { 126, 6, 20, 4 },
+    { 147, 7, 24, 5 },
+    { 168, 8, 29, 1 },
+    { 189, 9, 30, 4 },
+    { 210, 10, 34, 4 },
+    { 231, 11, 38, 6 },
+    { 252, 12, 44, 0 },
+    { 273, 13, 44, 4 },
+    { 294, 14, 48, 1 },
+    { 315, 15, 49, 4 },
+    { 336, 16, 53, 1 },
+    { 357, 17, 54, 3 },
+    { 378, 18, 57, 0 },
+    { 399, 19, 57, 2 },
+    { 420, 20, 59, 3 },
+    { 441, 21, 62, 3 },
+    { 462, 22, 65, 1 },
+    { 483, 23, 66, 1 },
+    { 504, 24, 67, 1 },
+    { 525, 25, 68, 2 },
+    { 546, 26, 70, 1 },
+    { 567, 27, 71, 1 },
+    { 588, 28, 72, 0 },
+    { 609, 29, 72, 2 },
+    { 630, 30, 74, 0 },
+    { 651, 31, 74, 4 },
+    { 672, 32, 78, 0 },
+    { 693, 33, 78, 1 },
+    { 714, 34, 79, 2 },
+    { 735, 35, 81, 0 },
+    { 756, 36, 81, 1 },
+    { 777, 37, 82, 2 },
+    { 798, 38, 84, 1 },
+    { 819, 39, 85, 0 },
+    { 840, 40, 85, 0 },
+    { 861, 41, 85, 0 },
+    { 882, 42, 85, 1 },
+    { 903, 43, 86, 0 },
+    { 924, 44, 86, 3 },
+    { 945, 45, 89, 2 },
+    { 966, 46, 91, 0 },
+    { 987, 47, 91, 1 },
+    { 1008, 48, 92, 0 },
+    { 1029, 49, 92, 6 },
+    { 1050, 50, 98, 1 },
+    { 1071, 51, 99, 0 },
+    { 1092, 52, 99, 0 },
+    { 1113, 53, 99, 0 },
+    { 1134, 54, 99, 0 },
+    { 1155, 55, 99, 1 },
+    { 1176, 56, 100, 1 },
+    { 1197, 57, 101, 0 },
+    { 1218, 58, 101, 2 },
+    { 1239, 59, 103, 4 },
+    { 1260, 60, 107, 0 },
+    { 1281, 61, 107, 2 },
+    { 1302, 62, 109, 3 },
+    { 1323, 63, 112, 0 },
+    { 1344, 64, 112, 0 },
+    { 1365, 65, 112, 0 },
+    { 1386, 66, 112, 0 },
+    { 1407, 67, 112, 1 },
+    { 1428, 68, 113, 1 },
+    { 1449, 69, 114, 6 },
+    { 1470, 70, 120, 1 },
+    { 1491, 71, 121, 0 },
+    { 1512, 72, 121, 0 },
+    { 1533, 73, 121, 1 },
+    { 1554, 74, 122, 0 },
+    { 1575, 75, 122, 6 },
+    { 1596, 76, 128, 0 },
+    { 1617, 77, 128, 4 },
+    { 1638, 78, 132, 0 },
+    { 1659, 79, 132, 1 },
+    { 1680, 80, 133, 3 },
+    { 1701, 81, 136, 4 },
+    { 1722, 82, 140, 0 },
+    { 1743, 83, 140, 1 },
+    { 1764, 84, 141, 0 },
+    { 1785, 85, 141, 3 },
+    { 1806, 86, 144, 0 },
+    { 1827, 87, 144, 1 },
+    { 1848, 88, 145, 2 },
+    { 1869, 89, 147, 1 },
+    { 1890, 90, 148, 2 },
+    { 1911, 91, 150, 2 },
+    { 1932, 92, 152, 2 },
+    { 1953, 93, 154, 1 },
+    { 1974, 94, 155, 0 },
+    { 1995, 95, 155, 0 },
+    { 2016, 96, 155, 3 },
+    { 2037, 97, 158, 1 },
+    { 2058, 98, 159, 0 },
+    { 2079, 99, 159, 5 },
+    { 2100, 100, 164, 0 },
+    { 2121, 101, 164, 1 },
+    { 2142, 102, 165, 1 },
+    { 2163, 103, 166, 0 },
+    { 2184, 104, 166, 0 },
+    { 2205, 105, 166, 1 },
+    { 2226, 106, 167, 3 },
+    { 2247, 107, 170, 0 },
+    { 2268, 108, 170, 0 },
+    { 2289, 109, 170, 4 },
+    { 2310, 110, 174, 0 },
+    { 2331, 111, 174, 1 },
+    { 2352, 112, 175, 1 },
+    { 2373, 113, 176, 0 },
+    { 2394, 114, 176, 1 },
+    { 2415, 115, 177, 1 },
+    { 2436, 116, 178, 1 },
+    { 2457, 117, 179, 2 },
+    { 2478, 118, 181, 1 },
+    { 2499, 119, 182, 3 },
+    { 2520, 120, 185, 1 },
+    { 2541, 121, 186, 0 },
+    { 2562, 122, 186, 0 },
+    { 2583, 123, 186, 0 },
+    { 2604, 124, 186, 0 },
+    { 2625, 125, 186, 1 },
+    { 2646, 126, 187, 0 },
+    { 2667, 127, 187, 0 },
+    { 2688, 128, 187, 0 },
+    { 2709, 129, 187, 1 },
+    { 2730, 130, 188, 0 },
+    { 2751, 131, 188, 0 },
+    { 2772, 132, 188, 0 },
+    { 2793, 133, 188, 0 },
+    { 2814, 134, 188, 1 },
+    { 2835, 135, 189, 0 },
+    { 2856, 136, 189, 0 },
+    { 2877, 137, 189, 2 },
+    { 2898, 138, 191, 0 },
+    { 2919, 139, 191, 0 },
+    { 2940, 140, 191, 0 },
+    { 2961, 141, 191, 0 },
+    { 2982, 142, 191, 1 },
+    { 3003, 143, 192, 0 },
+    { 3024, 144, 192, 0 },
+    { 3045, 145, 192, 4 },
+    { 3066, 146, 196, 0 },
+    { 3087, 147, 196, 0 },
+    { 3108, 148, 196, 1 },
+    { 3129, 149, 197, 0 },
+    { 3150, 150, 197, 0 },
+    { 3171, 151, 197, 0 },
+    { 3192, 152, 197, 0 },
+    { 3213, 153, 197, 0 },
+    { 3234, 154, 197, 0 },
+    { 3255, 155, 197, 0 },
+    { 3276, 156, 197, 0 },
+    { 3297, 157, 197, 0 },
+    { 3318, 158, 197, 0 },
+    { 3339, 159, 197, 1 },
+    { 3360, 160, 198, 0 },
+    { 3381, 161, 198, 0 },
+    { 3402, 162, 198, 1 },
+    { 3423, 163, 199, 0 },
+    { 3444, 164, 199, 0 },
+    { 3465, 165, 199, 0 },
+    { 3486, 166, 199, 0 },
+    { 3507, 167, 199, 1 },
+    { 3528, 168, 200, 0 },
+    { 3549, 169, 200, 0 },
+    { 3570, 170, 200, 0 },
+    { 3591, 171, 200, 2 },
+    { 3612, 172, 202, 0 },
+    { 3633, 173, 202, 1 },
+    { 3654, 174, 203, 0 },
+    { 3675, 175, 203, 1 },
+    { 3696, 176, 204, 0 },
+    { 3717, 177, 204, 0 },
+    { 3738, 178, 204, 0 },
+    { 3759, 179, 204, 0 },
+    { 3780, 180, 204, 0 },
+    { 3801, 181, 204, 2 },
+    { 3822, 182, 206, 0 },
+    { 3843, 183, 206, 2 },
+    { 3864, 184, 208, 0 },
+    { 3885, 185, 208, 0 },
+    { 3906, 186, 208, 0 },
+    { 3927, 187, 208, 0 },
+    { 3948, 188, 208, 0 },
+    { 3969, 189, 208, 1 },
+    { 3990, 190, 209, 0 },
+    { 4011, 191, 209, 1 },
+    { 4032, 192, 210, 0 },
+    { 4053, 193, 210, 0 },
+    { 4074, 194, 210, 0 },
+    { 4095, 195, 210, 0 },
+    { 4116, 196, 210, 0 },
+    { 4137, 197, 210, 0 },
+    { 4158, 198, 210, 1 },
+    { 4179, 199, 211, 0 },
+    { 4200, 200, 211, 0 },
+    { 4221, 201, 211, 0 },
+    { 4242, 202, 211, 1 },
+    { 4263, 203, 212, 0 },
+    { 4284, 204, 212, 0 },
+    { 4305, 205, 212, 0 },
+    { 4326, 206, 212, 0 },
+    { 4347, 207, 212, 1 },
+    { 4368, 208, 213, 1 },
+    { 4389, 209, 214, 0 },
+    { 4410, 210, 214, 0 },
+    { 4431, 211, 214, 0 },
+    { 4452, 212, 214, 0 },
+    { 4473, 213, 214, 0 },
+    { 4494, 214, 214, 1 },
+    { 4515, 215, 215, 0 }
+};
+
+static const int default_tree_sorted_nodes[216] = {
+    183, 157, 214, 167, 196, 182, 212, 133, 171, 190, 215, 177, 141, 202, 131, 213,
+    146, 124, 114, 210, 139, 111, 179, 156, 110, 184, 109, 181, 121, 211, 186, 117,
+    176, 136, 113, 209, 191, 127, 148, 115, 119, 189, 150, 172, 166, 178, 205, 123,
+    122, 204, 203, 192, 140, 154, 193, 138, 153, 174, 173, 201, 118, 170, 195, 129,
+    208, 206, 134, 197, 163, 108, 126, 188, 112, 147, 144, 132, 125, 164, 207, 200,
+    142, 165, 194, 143, 128, 169, 168, 145, 161, 199, 160, 155, 151, 149, 135, 180,
+    198, 116, 187, 130, 158, 185, 159, 175, 162, 120, 137, 152, 75, 49, 106, 59,
+    88, 74, 104, 25, 63, 82, 107, 69, 33, 94, 23, 105, 38, 16, 6, 102,
+    31, 3, 71, 48, 2, 76, 1, 73, 13, 103, 78, 9, 68, 28, 5, 101,
+    83, 19, 40, 7, 11, 81, 42, 64, 58, 70, 97, 15, 14, 96, 95, 84,
+    32, 46, 85, 30, 45, 66, 65, 93, 10, 62, 87, 21, 100, 98, 26, 89,
+    55, 0, 18, 80, 4, 39, 36, 24, 17, 56, 99, 92, 34, 57, 86, 35,
+    20, 61, 60, 37, 53, 91, 52, 47, 43, 41, 27, 72, 90, 8, 79, 22,
+    50, 77, 51, 67, 54, 12, 29, 44
+};
+
+static const TreeTableChild default_tree_children[215] = {
+    { 2, 1 }, { 3, 6 }, { 4, 11 }, { 1, 16 }, { 5, 75 }, { 6, 183 }, { 2, 2 }, { 1, 3 },
+    { 4, 5 }, { 3, 9 }, { 3, 4 }, { 4, 12 }, { 2, 39 }, { 1, 48 }, { 2, 60 }, { 3, 57 },
+    { 4, 8 }, { 2, 18 }, { 1, 28 }, { 3, 50 }, { 4, 7 }, { 3, 10 }, { 2, 17 }, { 5, 109 },
+    { 3, 13 }, { 2, 19 }, { 4, 62 }, { 5, 80 }, { 6, 197 }, { 2, 45 }, { 2, 14 }, { 3, 20 },
+    { 4, 36 }, { 1, 64 }, { 3, 15 }, { 2, 21 }, { 4, 31 }, { 5, 110 }, { 2, 29 }, { 1, 40 },
+    { 5, 49 }, { 3, 59 }, { 4, 69 }, { 6, 198 }, { 2, 33 }, { 3, 34 }, { 5, 44 }, { 4, 61 },
+    { 2, 26 }, { 4, 27 }, { 3, 37 }, { 5, 70 }, { 2, 78 }, { 2, 24 }, { 2, 22 }, { 3, 23 },
+    { 4, 25 }, { 3, 72 }, { 4, 149 }, { 1, 35 }, { 4, 38 }, { 2, 41 }, { 2, 30 }, { 3, 42 },
+    { 4, 192 }, { 2, 126 }, { 4, 32 }, { 2, 55 }, { 2, 82 }, { 3, 105 }, { 4, 46 }, { 4, 68 },
+    { 2, 58 }, { 4, 83 }, { 2, 71 }, { 1, 76 }, { 6, 113 }, { 3, 156 }, { 2, 74 }, { 3, 51 },
+    { 2, 52 }, { 2, 56 }, { 3, 43 }, { 4, 65 }, { 2, 124 }, { 3, 95 }, { 1, 53 }, { 2, 54 },
+    { 3, 128 }, { 2, 47 }, { 4, 89 }, { 3, 187 }, { 6, 96 }, { 4, 97 }, { 5, 129 }, { 2, 141 },
+    { 7, 175 }, { 3, 182 }, { 4, 84 }, { 2, 79 }, { 2, 132 }, { 2, 66 }, { 3, 135 }, { 4, 63 },
+    { 2, 73 }, { 5, 87 }, { 6, 145 }, { 3, 67 }, { 1, 86 }, { 5, 98 }, { 4, 155 }, { 3, 158 },
+    { 3, 143 }, { 4, 154 }, { 5, 77 }, { 4, 81 }, { 3, 85 }, { 2, 88 }, { 6, 125 }, { 7, 152 },
+    { 4, 136 }, { 2, 121 }, { 5, 99 }, { 2, 106 }, { 6, 119 }, { 7, 137 }, { 3, 167 }, { 4, 181 },
+    { 2, 91 }, { 3, 118 }, { 4, 130 }, { 5, 133 }, { 2, 108 }, { 2, 90 }, { 3, 116 }, { 4, 164 },
+    { 2, 93 }, { 3, 104 }, { 5, 140 }, { 4, 179 }, { 2, 127 }, { 2, 92 }, { 5, 131 }, { 4, 142 },
+    { 4, 115 }, { 2, 94 }, { 3, 102 }, { 2, 163 }, { 2, 100 }, { 4, 112 }, { 2, 160 }, { 4, 162 },
+    { 1, 103 }, { 4, 138 }, { 3, 150 }, { 5, 114 }, { 2, 203 }, { 4, 206 }, { 2, 123 }, { 2, 101 },
+    { 5, 148 }, { 6, 171 }, { 4, 191 }, { 3, 211 }, { 3, 200 }, { 2, 139 }, { 2, 146 }, { 2, 107 },
+    { 4, 157 }, { 3, 177 }, { 1, 111 }, { 3, 117 }, { 2, 120 }, { 4, 153 }, { 2, 168 }, { 2, 144 },
+    { 4, 170 }, { 3, 184 }, { 3, 134 }, { 2, 122 }, { 1, 172 }, { 3, 176 }, { 2, 166 }, { 4, 189 },
+    { 5, 204 }, { 2, 165 }, { 2, 159 }, { 2, 190 }, { 2, 147 }, { 2, 185 }, { 4, 199 }, { 1, 186 },
+    { 3, 151 }, { 1, 169 }, { 4, 173 }, { 2, 180 }, { 3, 212 }, { 3, 161 }, { 2, 194 }, { 2, 196 },
+    { 3, 174 }, { 2, 195 }, { 2, 178 }, { 3, 188 }, { 2, 202 }, { 3, 210 }, { 5, 207 }, { 2, 214 },
+    { 2, 201 }, { 2, 193 }, { 2, 208 }, { 2, 205 }, { 2, 209 }, { 2, 213 }, { 2, 215 }
+};
+
+static const TreeTable default_tree_table = {
+    216,            /* tree_count */
+    19, 19,         /* min_node_count, max_node_count */
+    2, 2,           /* min_depth, max_depth */
+    20,             /* max_treestring_length */
+    default_tree_nodes,
+    default_tree_sorted_nodes,
+    default_tree_children,
+    default_tree_strings,
+    4536            /* string_bytes */
+};
+
+#endif /* INCLUDED_DEFAULT_TREE_TABLE_H */
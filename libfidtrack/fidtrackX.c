@@ -65,12 +65,24 @@ static double calculate_angle( double dx, double dy )
     return result;
 }
 
-static void sum_leaf_centers( FidtrackerX *ft, Region *r, int width, int height )
+// the leaf sums of one fiducial, kept per candidate so that candidates can be
+// evaluated in parallel
+typedef struct LeafSums{
+    double black_x_sum, black_y_sum, black_leaf_count;
+    double white_x_sum, white_y_sum, white_leaf_count;
+    double black_x_sum_warped, black_y_sum_warped, black_leaf_count_warped;
+    double white_x_sum_warped, white_y_sum_warped, white_leaf_count_warped;
+    int total_leaf_count;
+    double total_leaf_size;
+} LeafSums;
+
+// depth is the distance of r from the root, as set by set_depth
+static void sum_leaf_centers( FidtrackerX *ft, LeafSums *sums, Region *r, int depth, int width, int height )
 {
     int i;
 	float leaf_size;
 
-    double radius = .5 + r->depth;
+    double radius = .5 + depth;
     double n = radius * radius * M_PI;  // weight according to depth circle area
 	
     if( r->adjacent_region_count == 1 ) {
@@ -78,7 +90,7 @@ static void sum_leaf_centers( FidtrackerX *ft, Region *r, int width, int height
 
 		leaf_size = ((r->bottom-r->top) + (r->right-r->left)) * .5f;
 		//printf("leaf: %f\n",leaf_size);
-		ft->total_leaf_size += leaf_size;
+		sums->total_leaf_size += leaf_size;
 		
         x = ((r->left + r->right) * .5f);
         y = ((r->top + r->bottom) * .5f);
@@ -92,38 +104,172 @@ static void sum_leaf_centers( FidtrackerX *ft, Region *r, int width, int height
 
 			if ((x>0) && (y>0)) {
 				if( r->colour == 0 ){
-					ft->black_x_sum_warped += x * n;
-					ft->black_y_sum_warped += y * n;
-					ft->black_leaf_count_warped += n;
+					sums->black_x_sum_warped += x * n;
+					sums->black_y_sum_warped += y * n;
+					sums->black_leaf_count_warped += n;
 				}else{
-					ft->white_x_sum_warped += x * n;
-					ft->white_y_sum_warped += y * n;
-					ft->white_leaf_count_warped += n;
+					sums->white_x_sum_warped += x * n;
+					sums->white_y_sum_warped += y * n;
+					sums->white_leaf_count_warped += n;
 				}
 			}
 		} 
 		
 		if( r->colour == 0 ){
-			ft->black_x_sum += x * n;
-			ft->black_y_sum += y * n;
-			ft->black_leaf_count += n;
+			sums->black_x_sum += x * n;
+			sums->black_y_sum += y * n;
+			sums->black_leaf_count += n;
 		}else{
-			ft->white_x_sum += x * n;
-			ft->white_y_sum += y * n;
-			ft->white_leaf_count += n;
+			sums->white_x_sum += x * n;
+			sums->white_y_sum += y * n;
+			sums->white_leaf_count += n;
 		}
 		
-		ft->total_leaf_count +=n;
+		sums->total_leaf_count +=n;
     }else{
         for( i=0; i < r->adjacent_region_count; ++i ){
             Region *adjacent = r->adjacent_regions[i];
             if( adjacent->level == TRAVERSED
                     && adjacent->descendent_count < r->descendent_count )
-                sum_leaf_centers( ft, adjacent, width, height );
+                sum_leaf_centers( ft, sums, adjacent, depth + 1, width, height );
         }
     }
 }
 
+typedef struct LeafMoments{
+    double black_x_sum, black_y_sum, black_weight;
+    double all_x_sum, all_y_sum, all_weight;
+} LeafMoments;
+
+// intensity weighted centroid of a leaf within its bounding box extended by one
+// pixel, where the weight is the contrast to the surrounding parent region
+static int leaf_centroid( FidtrackerX *ft, Region *r, int width, int height,
+        double *x, double *y )
+{
+    int left = r->left > 0 ? r->left - 1 : 0;
+    int right = r->right < width - 1 ? r->right + 1 : width - 1;
+    int top = r->top > 0 ? r->top - 1 : 0;
+    int bottom = r->bottom < height - 1 ? r->bottom + 1 : height - 1;
+    int min_value = 255, max_value = 0;
+    double sum = 0., x_sum = 0., y_sum = 0.;
+    const unsigned char *row;
+    int i, j;
+
+    for( j = top; j <= bottom; ++j ){
+        row = ft->grayscale + j * ft->grayscale_stride;
+        for( i = left; i <= right; ++i ){
+            if( row[i] < min_value ) min_value = row[i];
+            if( row[i] > max_value ) max_value = row[i];
+        }
+    }
+
+    for( j = top; j <= bottom; ++j ){
+        row = ft->grayscale + j * ft->grayscale_stride;
+        for( i = left; i <= right; ++i ){
+            int w = r->colour == 0 ? max_value - row[i] : row[i] - min_value;
+            sum += w;
+            x_sum += (double)w * i;
+            y_sum += (double)w * j;
+        }
+    }
+
+    if( sum <= 0. )
+        return 0;
+
+    *x = x_sum / sum;
+    *y = y_sum / sum;
+    return 1;
+}
+
+static void sum_leaf_moments( FidtrackerX *ft, LeafMoments *m, Region *r, int depth, int width, int height )
+{
+    int i;
+
+    double radius = .5 + depth;
+    double n = radius * radius * M_PI;  // same weights as in sum_leaf_centers
+
+    if( r->adjacent_region_count == 1 ) {
+        double x, y;
+
+        if( !leaf_centroid( ft, r, width, height, &x, &y ) ){
+            x = (r->left + r->right) * .5;
+            y = (r->top + r->bottom) * .5;
+        }
+
+        if( r->colour == 0 ){
+            m->black_x_sum += x * n;
+            m->black_y_sum += y * n;
+            m->black_weight += n;
+        }
+        m->all_x_sum += x * n;
+        m->all_y_sum += y * n;
+        m->all_weight += n;
+    }else{
+        for( i=0; i < r->adjacent_region_count; ++i ){
+            Region *adjacent = r->adjacent_regions[i];
+            if( adjacent->level == TRAVERSED
+                    && adjacent->descendent_count < r->descendent_count )
+                sum_leaf_moments( ft, m, adjacent, depth + 1, width, height );
+        }
+    }
+}
+
+// bilinear interpolation in the pixel warp map, fails if a neighbouring pixel is unmapped
+static int warp_position( FidtrackerX *ft, double *x, double *y, int width, int height )
+{
+    int x0 = (int)*x;
+    int y0 = (int)*y;
+    double fx = *x - x0;
+    double fy = *y - y0;
+    ShortPoint *p;
+    int i;
+
+    if( x0 < 0 || y0 < 0 || x0 + 1 >= width || y0 + 1 >= height )
+        return 0;
+
+    p = &ft->pixelwarp[ width*y0 + x0 ];
+    for( i = 0; i < 4; ++i ){
+        ShortPoint *q = p + (i & 1) + (i >> 1) * width;
+        if( q->x <= 0 && q->y <= 0 )
+            return 0;
+    }
+
+    *x = (1. - fy) * ((1. - fx) * p[0].x + fx * p[1].x)
+            + fy * ((1. - fx) * p[width].x + fx * p[width + 1].x);
+    *y = (1. - fy) * ((1. - fx) * p[0].y + fx * p[1].y)
+            + fy * ((1. - fx) * p[width].y + fx * p[width + 1].y);
+    return 1;
+}
+
+// replace the position and angle computed from the leaf bounding boxes by
+// the values computed from the grayscale leaf centroids
+static void refine_fiducial_position( FidtrackerX *ft, FiducialX *f,
+        Region *r, int width, int height )
+{
+    LeafMoments m;
+    double all_x, all_y, black_x, black_y;
+
+    memset( &m, 0, sizeof(m) );
+    sum_leaf_moments( ft, &m, r, 0, width, height );
+    if( m.black_weight <= 0. || m.all_weight <= 0. )
+        return;
+
+    all_x = m.all_x_sum / m.all_weight;
+    all_y = m.all_y_sum / m.all_weight;
+    black_x = m.black_x_sum / m.black_weight;
+    black_y = m.black_y_sum / m.black_weight;
+
+    if( ft->pixelwarp ){
+        if( !warp_position( ft, &all_x, &all_y, width, height )
+                || !warp_position( ft, &black_x, &black_y, width, height ) )
+            return;
+    }
+
+    f->x = (float)all_x;
+    f->y = (float)all_y;
+    f->angle = (float)calculate_angle( all_x - black_x, all_y - black_y );
+}
+
 /*
 static int check_leaf_variation( FidtrackerX *ft, Region *r, int width, int height )
 {
@@ -239,8 +385,38 @@ static void print_unordered_depth_string( Region *r )
 }
 #endif
 
+// the depth string of the root r with its colour prefix, as stored in the
+// tree id map. the depths must have been set by set_depth.
+static char *build_coloured_depth_string( FidtrackerX *ft, Region *r )
+{
+    char *depth_string;
+
+    ft->next_depth_string = 0;
+    depth_string = build_left_heavy_depth_string( ft, r );
+
+    ft->temp_coloured_depth_string[0] = (char)( r->colour ? 'w' : 'b' );
+    ft->temp_coloured_depth_string[1] = '\0';
+    strcat( ft->temp_coloured_depth_string, depth_string );
+
+    return ft->temp_coloured_depth_string;
+}
+
+// the tree id of the root r, or INVALID_FIDUCIAL_ID for lost symbols. this
+// is cheap compared to the statistics, so it is computed first.
+static int compute_fiducial_id( FidtrackerX *ft, Region *r )
+{
+    set_depth( r, 0 );
+    if( r->flags & LOST_SYMBOL_FLAG )
+        return INVALID_FIDUCIAL_ID;
+
+    return treestring_to_id( ft->treeidmap, build_coloured_depth_string( ft, r ) );
+}
+
+// the position, orientation and sizes of the root r, whose id has been
+// computed by compute_fiducial_id. regions are only read, apart from the
+// flags of r, so different roots can be evaluated in parallel.
 static void compute_fiducial_statistics( FidtrackerX *ft, FiducialX *f,
-        Region *r, int width, int height )
+        Region *r, int id, int width, int height )
 {
     double all_x = 0.;
 	double all_y = 0.;
@@ -251,40 +427,24 @@ static void compute_fiducial_statistics( FidtrackerX *ft, FiducialX *f,
 	double all_y_warped = 0.;
     double black_x_warped = 0.;
 	double black_y_warped = 0.;
-    char *depth_string;
+    double average_leaf_size;
+    LeafSums sums;
 
-    ft->black_x_sum = 0.;
-    ft->black_y_sum = 0.;
-    ft->black_leaf_count = 0.;
-    ft->white_x_sum = 0.;
-    ft->white_y_sum = 0.;
-    ft->white_leaf_count = 0.;
-
-	ft->black_x_sum_warped = 0.;
-    ft->black_y_sum_warped = 0.;
-    ft->black_leaf_count_warped = 0.;
-    ft->white_x_sum_warped = 0.;
-    ft->white_y_sum_warped = 0.;
-    ft->white_leaf_count_warped = 0.;
-	
-    ft->total_leaf_count = 0;
-    ft->total_leaf_size = 0.;	
-    ft->average_leaf_size = 0.;
+    memset( &sums, 0, sizeof(sums) );
 
 //    ft->min_leaf_width_or_height = 0x7FFFFFFF;
 
-    set_depth( r, 0 );
-    sum_leaf_centers( ft, r, width, height );
-    ft->average_leaf_size = ft->total_leaf_size / (double)(ft->total_leaf_count);
+    sum_leaf_centers( ft, &sums, r, 0, width, height );
+    average_leaf_size = sums.total_leaf_size / (double)(sums.total_leaf_count);
 
-	all_x = (double)(ft->black_x_sum + ft->white_x_sum) / (double)(ft->black_leaf_count + ft->white_leaf_count);
-	all_y = (double)(ft->black_y_sum + ft->white_y_sum) / (double)(ft->black_leaf_count + ft->white_leaf_count);
+	all_x = (double)(sums.black_x_sum + sums.white_x_sum) / (double)(sums.black_leaf_count + sums.white_leaf_count);
+	all_y = (double)(sums.black_y_sum + sums.white_y_sum) / (double)(sums.black_leaf_count + sums.white_leaf_count);
 	
-	black_x = (double)ft->black_x_sum / (double)ft->black_leaf_count;
-	black_y = (double)ft->black_y_sum / (double)ft->black_leaf_count;
+	black_x = (double)sums.black_x_sum / (double)sums.black_leaf_count;
+	black_y = (double)sums.black_y_sum / (double)sums.black_leaf_count;
 	
 	if (ft->pixelwarp) {
-		if (ft->total_leaf_count>(ft->black_leaf_count_warped+ft->white_leaf_count_warped)) { 
+		if (sums.total_leaf_count>(sums.black_leaf_count_warped+sums.white_leaf_count_warped)) { 
 			int pixel = width*(int)all_y+(int)all_x;
 
 			if ((pixel>=0) && (pixel<width*height)) {
@@ -312,11 +472,11 @@ static void compute_fiducial_statistics( FidtrackerX *ft, FiducialX *f,
 				}
 			} else r->flags |= LOST_SYMBOL_FLAG;
 		} else {
-			all_x_warped = (double)(ft->black_x_sum_warped + ft->white_x_sum_warped) / (double)(ft->black_leaf_count_warped + ft->white_leaf_count_warped);
-			all_y_warped = (double)(ft->black_y_sum_warped + ft->white_y_sum_warped) / (double)(ft->black_leaf_count_warped + ft->white_leaf_count_warped);
+			all_x_warped = (double)(sums.black_x_sum_warped + sums.white_x_sum_warped) / (double)(sums.black_leaf_count_warped + sums.white_leaf_count_warped);
+			all_y_warped = (double)(sums.black_y_sum_warped + sums.white_y_sum_warped) / (double)(sums.black_leaf_count_warped + sums.white_leaf_count_warped);
 			
-			black_x_warped = (double)ft->black_x_sum_warped / (double)ft->black_leaf_count_warped;
-			black_y_warped = (double)ft->black_y_sum_warped / (double)ft->black_leaf_count_warped;
+			black_x_warped = (double)sums.black_x_sum_warped / (double)sums.black_leaf_count_warped;
+			black_y_warped = (double)sums.black_y_sum_warped / (double)sums.black_leaf_count_warped;
 						
 			f->x = all_x_warped;
 			f->y = all_y_warped;
@@ -332,7 +492,7 @@ static void compute_fiducial_statistics( FidtrackerX *ft, FiducialX *f,
 	//f->a = black_x;
 	//f->b = black_y;
    
-    f->leaf_size = (float)(ft->average_leaf_size);
+    f->leaf_size = (float)average_leaf_size;
 	f->root_size = r->right-r->left;
 	if ((r->bottom-r->top)>f->root_size) f->root_size = r->bottom-r->top;
 	f->root_colour=r->colour;
@@ -353,18 +513,14 @@ static void compute_fiducial_statistics( FidtrackerX *ft, FiducialX *f,
 
 	if (r->flags & LOST_SYMBOL_FLAG) f->id = INVALID_FIDUCIAL_ID;
 	else {
-        ft->next_depth_string = 0;
-        depth_string = build_left_heavy_depth_string( ft, r );
-			
-        ft->temp_coloured_depth_string[0] = (char)( r->colour ? 'w' : 'b' );
-        ft->temp_coloured_depth_string[1] = '\0';
-        strcat( ft->temp_coloured_depth_string, depth_string );
+		f->id = id;
 
-		f->id = treestring_to_id( ft->treeidmap, ft->temp_coloured_depth_string );
+		if( f->id != INVALID_FIDUCIAL_ID && ft->grayscale )
+			refine_fiducial_position( ft, f, r, width, height );
 		/*if (f->id != INVALID_FIDUCIAL_ID) {
 			if (!(check_leaf_variation(ft, r, width, height)))  {
 				f->id = INVALID_FIDUCIAL_ID;
-				printf("filtered %f\n",ft->average_leaf_size);
+				printf("filtered %f\n",average_leaf_size);
 			}
 		}*/
     }
@@ -420,8 +576,9 @@ static int r1_adjacent_contains_r2( Region* r1, Region* r2 )
 // we never traverse above a node which exceeds these constraints. we also
 // never traverse nodes which are saturated or fragmented because it is
 // ambiguous whether such a node has a parent, or if all it's children are
-// attched, and we can't determine this in a single pass (we could save a list
-// of these nodes for a later pass but we don't bother.)
+// attched, and we can't determine this in a single pass. fragmented nodes
+// whose children except one have been traversed are saved in a list, and
+// resolve_deferred_regions later treats the remaining adjacent as their parent.
 // during the calls to this function we store the maximum leaf-to-node depth
 // in r->depth, later this field has a different meaning
 static void propagate_descendent_count_and_max_depth_upwards(
@@ -501,6 +658,16 @@ static void propagate_descendent_count_and_max_depth_upwards(
                     assert( r1_adjacent_contains_r2( parent, r ) );
 
                     propagate_descendent_count_and_max_depth_upwards( s, parent, ft);
+
+                }else if( (parent->flags & (SATURATED_REGION_FLAG | ADJACENT_TO_ROOT_REGION_FLAG | FRAGMENTED_REGION_FLAG))
+                            == FRAGMENTED_REGION_FLAG
+                        && parent->children_visited_count == (parent->adjacent_region_count - 1)
+                        && ft->deferred_region_count < ft->max_deferred_regions ){
+
+                    // parent has either lost its own parent and has one more
+                    // child, or it has lost a child and the remaining adjacent
+                    // is its parent. decide this after all leafs are processed
+                    ft->deferred_regions[ ft->deferred_region_count++ ] = parent;
                 }
             }
         }
@@ -508,6 +675,28 @@ static void propagate_descendent_count_and_max_depth_upwards(
 }
 
 
+// second pass over the fragmented nodes saved by
+// propagate_descendent_count_and_max_depth_upwards. if no other child has
+// reached such a node during the first pass, its remaining untraversed
+// adjacent is assumed to be its parent, which recovers fiducials where a
+// noisy child region became saturated. the list grows while it is processed,
+// and its length is limited by max_deferred_regions to bound the time spent.
+static void resolve_deferred_regions( Segmenter *s, FidtrackerX *ft )
+{
+    int i;
+
+    for( i=0; i < ft->deferred_region_count; ++i ){
+        Region *r = ft->deferred_regions[i];
+
+        if( r->level == NOT_TRAVERSED
+                && r->children_visited_count == (r->adjacent_region_count - 1) ){
+            ++ft->stats.deferred_count;
+            propagate_descendent_count_and_max_depth_upwards( s, r, ft);
+        }
+    }
+}
+
+
 
 
 
@@ -536,24 +725,24 @@ static void find_roots( Segmenter *s, FidtrackerX *ft)
     sanity_check_region_initial_values( s );
 #endif
 
-    // find fiducial roots beginning at leafs
+    ft->deferred_region_count = 0;
+    ft->stats.deferred_count = 0;
 
-    for( i=0; i < s->region_count; ++i ){
-        Region *r = LOOKUP_SEGMENTER_REGION( s, i );
+    // find fiducial roots beginning at leafs, which the segmenter has indexed
 
-        if( r->adjacent_region_count == 1
-                && !(r->flags & (   SATURATED_REGION_FLAG |
-                                    FRAGMENTED_REGION_FLAG |
-                                    ADJACENT_TO_ROOT_REGION_FLAG |
-                                    FREE_REGION_FLAG ) )
-                ){
-
-            assert( r->level == NOT_TRAVERSED );
-            assert( r->children_visited_count == 0 );
-            propagate_descendent_count_and_max_depth_upwards( s, r, ft);
-       } 
+    for( i=0; i < s->leaf_region_count; ++i ){
+        Region *r = LOOKUP_SEGMENTER_REGION( s, s->leaf_regions[i] );
 
+        assert( r->adjacent_region_count == 1 );
+        assert( r->level == NOT_TRAVERSED );
+        assert( r->children_visited_count == 0 );
+        propagate_descendent_count_and_max_depth_upwards( s, r, ft);
     }
+
+    resolve_deferred_regions( s, ft );
+
+    ft->stats.saturated_count = s->stats.saturated_region_count;
+    ft->stats.fragmented_count = s->stats.fragmented_region_count;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -570,8 +759,9 @@ void initialize_fidtrackerX( FidtrackerX *ft, TreeIdMap *treeidmap, ShortPoint *
     ft->min_depth = treeidmap->min_depth;
     ft->max_depth = treeidmap->max_depth;
 
-    ft->depth_string_count = treeidmap->max_node_count;
-    ft->depth_string_length = treeidmap->max_node_count + 1;
+    // lost symbols have up to FUZZY_NODE_RANGE more nodes, see find_approximate_idX
+    ft->depth_string_count = treeidmap->max_node_count + FUZZY_NODE_RANGE;
+    ft->depth_string_length = treeidmap->max_node_count + FUZZY_NODE_RANGE + 1;
     ft->depth_strings = (char*)malloc( ft->depth_string_count * ft->depth_string_length );
 
     ft->temp_coloured_depth_string = (char*)malloc( ft->depth_string_length + 1 );
@@ -579,6 +769,23 @@ void initialize_fidtrackerX( FidtrackerX *ft, TreeIdMap *treeidmap, ShortPoint *
 
     ft->treeidmap = treeidmap;
     ft->pixelwarp = pixelwarp;
+
+    ft->grayscale = 0;
+    ft->grayscale_stride = 0;
+
+    ft->deferred_regions = 0;
+    ft->deferred_region_count = 0;
+    ft->max_deferred_regions = 0;
+
+    ft->expected_ids = 0;
+    ft->found_ids = 0;
+    ft->expected_id_count = 0;
+    ft->expected_id_range = 0;
+
+    ft->candidate_roots = 0;
+    ft->max_candidate_roots = 0;
+
+    memset( &ft->stats, 0, sizeof(FidtrackerXStats) );
 }
 
 
@@ -586,33 +793,168 @@ void terminate_fidtrackerX( FidtrackerX *ft )
 {
     free( ft->depth_strings );
     free( ft->temp_coloured_depth_string );
+    free( ft->deferred_regions );
+    free( ft->expected_ids );
+    free( ft->found_ids );
+    free( ft->candidate_roots );
 }
 
 
-int find_fiducialsX( FiducialX *fiducials, int max_count,
-        FidtrackerX *ft, Segmenter *segments, int width, int height)
+void set_deferred_regionsX( FidtrackerX *ft, int max_regions )
+{
+    free( ft->deferred_regions );
+    ft->deferred_regions = max_regions > 0 ? (Region**)malloc( sizeof(Region*) * max_regions ) : 0;
+    ft->max_deferred_regions = ft->deferred_regions ? max_regions : 0;
+    ft->deferred_region_count = 0;
+}
+
+
+void set_expected_idsX( FidtrackerX *ft, const int *ids, int count )
+{
+    int i;
+    int id_range = 0;
+    const TreeTable *table = ft->treeidmap->table;
+
+    free( ft->expected_ids );
+    free( ft->found_ids );
+    ft->expected_ids = 0;
+    ft->found_ids = 0;
+    ft->expected_id_count = 0;
+    ft->expected_id_range = 0;
+    if( count <= 0 )
+        return;
+
+    // ids are not dense: the loaders skip the ids of duplicate trees
+    for( i=0; i < table->tree_count; ++i ){
+        if( table->nodes[i].id >= id_range )
+            id_range = table->nodes[i].id + 1;
+    }
+    if( id_range == 0 )
+        return;
+
+    ft->expected_ids = (unsigned char*)calloc( id_range, 1 );
+    ft->found_ids = (unsigned char*)calloc( id_range, 1 );
+    if( !ft->expected_ids || !ft->found_ids ){
+        free( ft->expected_ids );
+        free( ft->found_ids );
+        ft->expected_ids = 0;
+        ft->found_ids = 0;
+        return;
+    }
+    ft->expected_id_range = id_range;
+    for( i=0; i < count; ++i ){
+        if( ids[i] >= 0 && ids[i] < id_range && !ft->expected_ids[ ids[i] ] ){
+            ft->expected_ids[ ids[i] ] = 1;
+            ++ft->expected_id_count;
+        }
+    }
+}
+
+
+void set_grayscale_imageX( FidtrackerX *ft, const unsigned char *grayscale, int stride )
+{
+    ft->grayscale = grayscale;
+    ft->grayscale_stride = stride;
+}
+
+
+int find_fiducial_candidatesX( FiducialX *fiducials, int max_count,
+        FidtrackerX *ft, Segmenter *segments )
 {
     int i = 0;
+    int found_count;
     Region *next;
 
+    if( max_count > ft->max_candidate_roots ){
+        free( ft->candidate_roots );
+        ft->candidate_roots = (Region**)malloc( sizeof(Region*) * max_count );
+        ft->max_candidate_roots = ft->candidate_roots ? max_count : 0;
+        if( max_count > ft->max_candidate_roots )
+            max_count = ft->max_candidate_roots;
+    }
+
     initialize_head_region( &ft->root_regions_head );
 
     find_roots( segments, ft);
 
+    ft->stats.candidate_count = 0;
+    ft->stats.lost_symbol_count = 0;
+    ft->stats.invalid_id_count = 0;
+    ft->stats.unexpected_id_count = 0;
+
+    if( ft->expected_ids )
+        memset( ft->found_ids, 0, ft->expected_id_range );
+    found_count = 0;
+
     next = ft->root_regions_head.next;
     while( next != &ft->root_regions_head ){
 
-        compute_fiducial_statistics( ft, &fiducials[i], next, width, height );
+        // the remaining candidates are only counted
+        if( i < max_count ){
+            int id = compute_fiducial_id( ft, next );
+            int expected = !ft->expected_ids || id == INVALID_FIDUCIAL_ID || ft->expected_ids[id];
+
+            if( next->flags & LOST_SYMBOL_FLAG )
+                ++ft->stats.lost_symbol_count;
+            else if( id == INVALID_FIDUCIAL_ID )
+                ++ft->stats.invalid_id_count;
+            else if( !expected )
+                ++ft->stats.unexpected_id_count;
+
+            // candidates with unexpected valid ids are skipped without statistics
+            if( expected ){
+                if( ft->expected_ids && id != INVALID_FIDUCIAL_ID && !ft->found_ids[id] ){
+                    ft->found_ids[id] = 1;
+                    ++found_count;
+                }
+                fiducials[i].id = id;
+                ft->candidate_roots[i] = next;
+                ++i;
+            }
+        }
 
+        ++ft->stats.candidate_count;
         next = next->next;
-        ++i;
-        if( i >= max_count )
-            return i;
+
+        if( ft->expected_ids && found_count == ft->expected_id_count )
+            break;
     }
 
     return i;
 }
 
+
+void compute_fiducial_statisticsX( FidtrackerX *ft, FiducialX *fiducials, int first, int count,
+        int width, int height )
+{
+    int i;
+
+    for( i = first; i < first + count; ++i )
+        compute_fiducial_statistics( ft, &fiducials[i], ft->candidate_roots[i], fiducials[i].id, width, height );
+}
+
+
+int find_approximate_idX( FidtrackerX *ft, int candidate, int max_distance, int preferred_id,
+        int *budget )
+{
+    Region *r = ft->candidate_roots[ candidate ];
+
+    // the depths may have been changed by nested candidates
+    set_depth( r, 0 );
+    return treestring_to_nearest_id( ft->treeidmap, build_coloured_depth_string( ft, r ),
+            max_distance, preferred_id, budget );
+}
+
+
+int find_fiducialsX( FiducialX *fiducials, int max_count,
+        FidtrackerX *ft, Segmenter *segments, int width, int height)
+{
+    int count = find_fiducial_candidatesX( fiducials, max_count, ft, segments );
+
+    compute_fiducial_statisticsX( ft, fiducials, 0, count, width, height );
+    return count;
+}
+
 int find_regionsX( RegionX *regions, int max_count,
         FidtrackerX *ft, Segmenter *segments, int width, int height, int min_size, int max_size)
 {
@@ -629,8 +971,8 @@ int find_regionsX( RegionX *regions, int max_count,
 
     initialize_head_region( &ft->root_regions_head );	
 	
-	for( i=0; i < segments->region_count; ++i ) {
-		Region *r = LOOKUP_SEGMENTER_REGION( segments, i );
+	for( i=0; i < segments->live_region_count; ++i ) {
+		Region *r = LOOKUP_SEGMENTER_REGION( segments, segments->live_regions[i] );
 
 			regions[j].left = r->left;
 			regions[j].right = r->right;
@@ -675,3 +1017,4 @@ int find_regionsX( RegionX *regions, int max_count,
 	return j;
 	
 }
+
@@ -31,6 +31,19 @@ extern "C"
 #include "treeidmap.h"
 #include "floatpoint.h"
 
+/*
+    counters of the last call of find_fiducialsX
+*/
+typedef struct FidtrackerXStats{
+    int saturated_count;        /* regions whose adjacency list overflowed */
+    int fragmented_count;       /* regions that lost adjacencies to saturated regions */
+    int candidate_count;        /* root regions with a plausible node count and depth */
+    int lost_symbol_count;      /* candidates with a fuzzy node count */
+    int invalid_id_count;       /* other candidates whose tree is not in the tree id map */
+    int unexpected_id_count;    /* candidates with a valid id that is not expected */
+    int deferred_count;         /* fragmented regions traversed by the deferred pass */
+} FidtrackerXStats;
+
 typedef struct FidtrackerX{
 
     int min_target_root_descendent_count;
@@ -47,19 +60,26 @@ typedef struct FidtrackerX{
     int next_depth_string;
     char *temp_coloured_depth_string;
 
-    double black_x_sum, black_y_sum, black_leaf_count;
-    double white_x_sum, white_y_sum, white_leaf_count;
-	double black_x_sum_warped, black_y_sum_warped, black_leaf_count_warped;
-    double white_x_sum_warped, white_y_sum_warped, white_leaf_count_warped;
-
- //   int min_leaf_width_or_height;
-	int total_leaf_count;
-    double total_leaf_size;
-    double average_leaf_size;
-
     TreeIdMap *treeidmap;
     ShortPoint *pixelwarp;
 
+    const unsigned char *grayscale;
+    int grayscale_stride;
+
+    Region **deferred_regions;
+    int deferred_region_count;
+    int max_deferred_regions;
+
+    unsigned char *expected_ids;    /* indexed by tree id, see set_expected_idsX */
+    unsigned char *found_ids;
+    int expected_id_count;
+    int expected_id_range;          /* the largest tree id + 1 */
+
+    Region **candidate_roots;       /* the root of each candidate of the last frame */
+    int max_candidate_roots;
+
+    FidtrackerXStats stats;
+
 } FidtrackerX;
 
 /* pixelwarp is a Width by Height array of pixel coordinates and can be NULL */
@@ -68,6 +88,35 @@ void initialize_fidtrackerX( FidtrackerX *ft, TreeIdMap *treeidmap, ShortPoint *
 
 void terminate_fidtrackerX( FidtrackerX *ft );
 
+/*
+    grayscale is an optional image of the same size as the segmented image, with
+    rows that are stride bytes apart. If it is not NULL, the position and angle of
+    fiducials with a valid id are refined with sub-pixel accuracy from the
+    intensity weighted centroids of their leafs. Set it before each call of
+    find_fiducialsX, or to NULL to disable the refinement.
+*/
+void set_grayscale_imageX( FidtrackerX *ft, const unsigned char *grayscale, int stride );
+
+/*
+    fragmented regions can either have lost their parent or one of their
+    children to a saturated region. the first case is resolved while
+    searching fiducial roots, the second one needs a deferred pass over up to
+    max_regions fragmented regions per frame, which limits the time spent on
+    cluttered frames. the deferred pass is disabled by default (max_regions 0).
+*/
+void set_deferred_regionsX( FidtrackerX *ft, int max_regions );
+
+/*
+    restricts find_fiducialsX to the given ids. the id of each candidate is
+    computed first, and candidates with other valid ids are skipped without
+    computing their statistics. candidates without valid id are still
+    returned, so that callers can count them or match them approximately.
+    the search stops once every expected id has been found, so the stats
+    then only count the inspected candidates. ids outside the tree id map are
+    ignored, a count of 0 accepts all ids again.
+*/
+void set_expected_idsX( FidtrackerX *ft, const int *ids, int count );
+
 
 
 #define INVALID_FIDUCIAL_ID  INVALID_TREE_ID
@@ -111,6 +160,30 @@ typedef struct RegionX{
 int find_fiducialsX( FiducialX *fiducials, int max_count,
         FidtrackerX *ft, Segmenter *segments, int width, int height);
 
+/*
+    find_fiducialsX in two steps, so that the statistics of many candidates
+    can be computed by several threads. find_fiducial_candidatesX finds the
+    candidates and their ids, then compute_fiducial_statisticsX computes the
+    positions of the candidates from first to first + count - 1. the latter
+    doesn't change shared state, so disjoint ranges can be computed in
+    parallel.
+*/
+int find_fiducial_candidatesX( FiducialX *fiducials, int max_count,
+        FidtrackerX *ft, Segmenter *segments );
+
+void compute_fiducial_statisticsX( FidtrackerX *ft, FiducialX *fiducials, int first, int count,
+        int width, int height );
+
+/*
+    the id of the tree closest to the one of the given candidate of the last
+    call of find_fiducial_candidatesX, for candidates without valid id, e.g.
+    because a hand covers part of the fiducial. see treestring_to_nearest_id
+    for max_distance, preferred_id and budget. the segmenter must not have been
+    stepped since the candidates were found.
+*/
+int find_approximate_idX( FidtrackerX *ft, int candidate, int max_distance, int preferred_id,
+        int *budget );
+
 int find_regionsX( RegionX *regions, int max_count,
         FidtrackerX *ft, Segmenter *segments, int width, int height, int min_size, int max_size);
 
@@ -23,6 +23,10 @@
 #include <stdlib.h>
 #include <assert.h>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 
 /* -------------------------------------------------------------------------- */
 
@@ -52,9 +56,10 @@ void unlink_region( Region* r )
 /* -------------------------------------------------------------------------- */
 
 
-static RegionReference* new_region( Segmenter *s, int x, int y, int colour )
+// returns the label of the new region
+static int new_region( Segmenter *s, int x, int y, int colour )
 {
-    RegionReference *result;
+    int label;
     Region *r;
 	int i;
 
@@ -92,11 +97,28 @@ static RegionReference* new_region( Segmenter *s, int x, int y, int colour )
 	r->last_span = r->first_span;
 	r->last_span->next = NULL;
 */
-    result = &s->region_refs[ s->region_ref_count++ ];
-    result->redirect = result;
-    result->region = r;
+    label = s->label_count++;
+    s->label_parents[label] = label;
+    s->label_sizes[label] = 1;
+    s->label_regions[label] = (int)(((unsigned char*)r - s->regions) / s->sizeof_region);
 
-    return result;
+    return label;
+}
+
+
+#define LABEL_REGION( s, label ) (LOOKUP_SEGMENTER_REGION( s, (s)->label_regions[label] ))
+
+
+// the root label of the tree containing label, with path halving
+static int find_label( Segmenter *s, int label )
+{
+    int *parents = s->label_parents;
+
+    while( parents[label] != label ){
+        parents[label] = parents[parents[label]];
+        label = parents[label];
+    }
+    return label;
 }
 
 
@@ -190,22 +212,6 @@ static void make_saturated( Region* r1 )
     r1->flags |= SATURATED_REGION_FLAG;
 }
 
-/*
-static void make_fragmented( Region* r1 )
-{
-    int i;
-    int r1_adjacent_region_count = r1->adjacent_region_count; 
-
-    // remove adjacencies from r1
-    for( i = 0; i < r1_adjacent_region_count; ++i ){
-        Region *a = r1->adjacent_regions[i];
-
-        remove_adjacent_from( a, r1 );
-    }
-    r1->adjacent_region_count = 0;
-    r1->flags |= FRAGMENTED_REGION_FLAG;
-}
-*/
 
 static void make_adjacent( Segmenter *s, Region* r1, Region* r2 )
 {
@@ -343,14 +349,108 @@ static void merge_regions( Segmenter *s, Region* r1, Region* r2 )
 }
 
 
+// merge the region of the root label from into the region of the root label
+// into. the region of into is kept, as it is usually the older and better
+// connected one, while the smaller tree is attached to the larger one so that
+// find_label stays cheap on noisy images. returns the new root label.
+static int merge_labels( Segmenter *s, int into, int from )
+{
+    Region *r1 = LABEL_REGION( s, into );
+    Region *r2 = LABEL_REGION( s, from );
+    int region = s->label_regions[into];
+
+    merge_regions( s, r1, r2 );
+    ++s->stats.merged_region_count;
+    r2->flags = FREE_REGION_FLAG;
+    r2->next = s->freed_regions_head;
+    s->freed_regions_head = r2;
+
+    if( s->label_sizes[into] < s->label_sizes[from] ){
+        int temp = into;
+        into = from;
+        from = temp;
+    }
+    s->label_parents[from] = into;
+    s->label_sizes[into] += s->label_sizes[from];
+    s->label_regions[into] = region;
+
+    return into;
+}
+
+
+// is the region of the run from start to end in row y a noise region, given
+// that no pixel below the run has its colour? the region may not have pixels
+// beside the run in the rows above, otherwise it could continue elsewhere.
+static int is_noise_region( Segmenter *s, Region *r, int start, int end, int y )
+{
+    return r->flags == NO_REGION_FLAG
+            && r->adjacent_region_count == 1
+            && r->left == start && r->right == end
+            && (end - start + 1) * (y - r->top + 1) <= s->max_noise_area;
+}
+
+
+// fold the noise region of label into the region of the root label into,
+// which is its only neighbour. the pixels below will join the region of into
+// through the union-find forest.
+static void fold_region( Segmenter *s, int label, int into )
+{
+    Region *r = LABEL_REGION( s, label );
+
+    assert( r->adjacent_regions[0] == LABEL_REGION( s, into ) );
+    remove_adjacent_from( r->adjacent_regions[0], r );
+    r->adjacent_region_count = 0;
+    ++s->stats.folded_region_count;
+    r->flags = FREE_REGION_FLAG;
+    r->next = s->freed_regions_head;
+    s->freed_regions_head = r;
+
+    s->label_parents[label] = into;
+    s->label_sizes[into] += s->label_sizes[label];
+}
+
+
+// collect the live and leaf regions from the root labels once the regions are
+// complete. the leaves are the starting points of the fiducial search.
+static void index_regions( Segmenter *s )
+{
+    int label;
+    int live_count = 0, leaf_count = 0;
+    int saturated_count = 0, fragmented_count = 0;
+
+    for( label = 0; label < s->label_count; ++label ){
+        if( s->label_parents[label] == label ){
+            int index = s->label_regions[label];
+            Region *r = LOOKUP_SEGMENTER_REGION( s, index );
+
+            s->live_regions[live_count++] = index;
+            saturated_count += (r->flags & SATURATED_REGION_FLAG) != 0;
+            fragmented_count += (r->flags & FRAGMENTED_REGION_FLAG) != 0;
+            if( r->adjacent_region_count == 1
+                    && !(r->flags & ( SATURATED_REGION_FLAG |
+                                      FRAGMENTED_REGION_FLAG |
+                                      ADJACENT_TO_ROOT_REGION_FLAG )) )
+                s->leaf_regions[leaf_count++] = index;
+        }
+    }
+
+    s->live_region_count = live_count;
+    s->leaf_region_count = leaf_count;
+    s->stats.saturated_region_count = saturated_count;
+    s->stats.fragmented_region_count = fragmented_count;
+}
+
+
 static void build_regions( Segmenter *s, const unsigned char *source )
 {
     //Span *new_span;
 	int x, y, i;
-    RegionReference **current_row = &s->regions_under_construction[0];
-    RegionReference **previous_row = &s->regions_under_construction[s->width];
+    int *current_row = &s->regions_under_construction[0];
+    int *previous_row = &s->regions_under_construction[s->width];
+    int run_start;
+    Region *above;
 
-    s->region_ref_count = 0;
+    s->label_count = 0;
     s->region_count = 0;
     s->freed_regions_head = 0;
 
@@ -359,7 +459,7 @@ static void build_regions( Segmenter *s, const unsigned char *source )
     x = 0;
     y = 0;
     current_row[0] = new_region( s, x, y, source[0] );
-    current_row[0]->region->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
+    LABEL_REGION( s, current_row[0] )->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
     for( x=1, y=0, i=1 ; x < s->width; ++x, ++i ){
 
         if( source[i] == source[i-1] ){
@@ -368,8 +468,8 @@ static void build_regions( Segmenter *s, const unsigned char *source )
 //			current_row[x-1]->region->last_span->end=i-1;
 //			current_row[x-1]->region->area += i-current_row[x-1]->region->last_span->start;
             current_row[x] = new_region( s, x, y, source[i] );
-            current_row[x]->region->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
-            make_adjacent( s, current_row[x]->region, current_row[x-1]->region );
+            LABEL_REGION( s, current_row[x] )->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
+            make_adjacent( s, LABEL_REGION( s, current_row[x] ), LABEL_REGION( s, current_row[x-1] ) );
         }
     }
 
@@ -378,7 +478,7 @@ static void build_regions( Segmenter *s, const unsigned char *source )
     for( y=1; y < s->height; ++y ){
 
         // swap previous and current rows
-        RegionReference **temp = previous_row;
+        int *temp = previous_row;
         previous_row = current_row;
         current_row = temp;
 
@@ -387,8 +487,9 @@ static void build_regions( Segmenter *s, const unsigned char *source )
 
         // left edge
 
-        RESOLVE_REGIONREF_REDIRECTS( previous_row[x], previous_row[x] );
-        if( source[i] == previous_row[x]->region->colour ){
+        previous_row[x] = find_label( s, previous_row[x] );
+        above = LABEL_REGION( s, previous_row[x] );
+        if( source[i] == above->colour ){
             current_row[x] = previous_row[x];
 /*
 			new_span = LOOKUP_SEGMENTER_SPAN( s,  i );
@@ -401,25 +502,27 @@ static void build_regions( Segmenter *s, const unsigned char *source )
 		}else{ // source[i] != previous_row[x]->colour
 
             current_row[x] = new_region( s, x, y, source[i] );
-            current_row[x]->region->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
-            make_adjacent( s, current_row[x]->region, previous_row[x]->region );
+            LABEL_REGION( s, current_row[x] )->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
+            make_adjacent( s, LABEL_REGION( s, current_row[x] ), above );
         }
 
         ++i;
         x=1;
+        run_start = 0;
 
         // center span
 
         for( ; x < s->width; ++x, ++i ){
-            //RESOLVE_REGIONREF_REDIRECTS( current_row[x-1], current_row[x-1] );   // this isn't needed because the the west cell's redirect is always up to date
-            RESOLVE_REGIONREF_REDIRECTS( previous_row[x], previous_row[x] );
+            // the west label doesn't need to be resolved because it is always a root
+            if( s->label_parents[previous_row[x]] != previous_row[x] )
+                previous_row[x] = find_label( s, previous_row[x] );
 
             if( source[i] == source[i-1] ){
 
                 current_row[x] = current_row[x-1];
 
                 if( current_row[x] != previous_row[x]
-                        && source[i] == previous_row[x]->region->colour ){
+                        && source[i] == LABEL_REGION( s, previous_row[x] )->colour ){
 
                     // merge the current region into the previous one
                     // this should be more efficient than merging the previous
@@ -430,33 +533,19 @@ static void build_regions( Segmenter *s, const unsigned char *source )
 					previous_row[x]->region->last_span = current_row[x]->region->last_span;
 					previous_row[x]->region->area += current_row[x]->region->area;
 */
-                    merge_regions( s, previous_row[x]->region, current_row[x]->region );
-                    current_row[x]->region->flags = FREE_REGION_FLAG;
-                    current_row[x]->region->next = s->freed_regions_head;
-                    s->freed_regions_head = current_row[x]->region;
-                    current_row[x]->region = 0;
-                    current_row[x]->redirect = previous_row[x];
-                    current_row[x] = previous_row[x];
+                    current_row[x] = merge_labels( s, previous_row[x], current_row[x] );
                 }
 
 
             }else{ // source_image_[i] != source_image_[i-1]
-/*
-				current_row[x-1]->region->last_span->end=i-1; // set the span end, it is more efficient here
-				current_row[x-1]->region->area+=i-current_row[x-1]->region->last_span->start;
-				
-				// mark single pixels fragmented
-				if (current_row[x-1]->region->area<=REGION_GATE_AREA) {
-					if (((y+1)==s->height) || (source[i-1]!=source[i-1+s->width]))
-						make_fragmented(current_row[x-1]->region);
-				}
-*/
-                if( current_row[x-1]->region->right < x - 1 )
-                    current_row[x-1]->region->right = (short)( x - 1 );
+                Region *west = LABEL_REGION( s, current_row[x-1] );
+                above = LABEL_REGION( s, previous_row[x] );
+                if( west->right < x - 1 )
+                    west->right = (short)( x - 1 );
 
-                if( source[i] == previous_row[x]->region->colour ){
+                if( source[i] == above->colour ){
                     current_row[x] = previous_row[x];
-                    current_row[x]->region->bottom = (short)y;
+                    above->bottom = (short)y;
 /*
 					new_span = LOOKUP_SEGMENTER_SPAN( s,  i );
 					new_span->start = i;
@@ -467,15 +556,27 @@ static void build_regions( Segmenter *s, const unsigned char *source )
 */
                 }else{
                     current_row[x] = new_region( s, x, y, source[i] );
-                    make_adjacent( s, current_row[x]->region, previous_row[x]->region );
-                    if( current_row[x-1]->region != previous_row[x]->region )
-                        make_adjacent( s, current_row[x]->region, current_row[x-1]->region );
+                    make_adjacent( s, LABEL_REGION( s, current_row[x] ), above );
+                    if( west != above )
+                        make_adjacent( s, LABEL_REGION( s, current_row[x] ), west );
                 }
+
+                // the west run is closed if no pixel below has its colour
+                if( s->max_noise_area > 0 && y + 1 < s->height
+                        && is_noise_region( s, west, run_start, x - 1, y ) ){
+                    const unsigned char *below = source + i + s->width;
+                    int k = run_start - x;
+                    while( k < 0 && below[k] != west->colour )
+                        ++k;
+                    if( k == 0 )
+                        fold_region( s, current_row[x-1], current_row[x] );
+                }
+                run_start = x;
             }
         }
 
         // right edge
-        current_row[s->width-1]->region->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
+        LABEL_REGION( s, current_row[s->width-1] )->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
 //		current_row[s->width-1]->region->last_span->end=i;
 //		current_row[x-1]->region->area+=i-current_row[x-1]->region->last_span->start+2;
     }
@@ -483,9 +584,207 @@ static void build_regions( Segmenter *s, const unsigned char *source )
     // make regions of bottom row adjacent or merge with root
 
     for( x = 0; x < s->width; ++x ){
-        RESOLVE_REGIONREF_REDIRECTS( current_row[x], current_row[x] );
-        current_row[x]->region->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
+        LABEL_REGION( s, find_label( s, current_row[x] ) )->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
     }
+
+    index_regions( s );
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+// index of the lowest set bit, x must not be zero
+#if defined( _MSC_VER )
+static int count_trailing_zeros( PackedWord x )
+{
+    unsigned long index;
+    if( _BitScanForward( &index, (unsigned long)x ) )
+        return (int)index;
+    _BitScanForward( &index, (unsigned long)(x >> 32) );
+    return (int)index + 32;
+}
+#elif defined( __GNUC__ )
+#define count_trailing_zeros( x )   __builtin_ctzll( x )
+#else
+static int count_trailing_zeros( PackedWord x )
+{
+    int result = 0;
+    while( !(x & 1) ){
+        x >>= 1;
+        ++result;
+    }
+    return result;
+}
+#endif
+
+#define PACKED_COLOUR( word, bit )  ((((word) >> (bit)) & 1) ? 255 : 0)
+
+
+// does any pixel from start to end in the bit-packed row have the colour?
+static int packed_span_has_colour( const PackedWord *row, int start, int end, int colour )
+{
+    int x;
+
+    for( x = start; x <= end; ++x )
+        if( PACKED_COLOUR( row[x / 64], x % 64 ) == colour )
+            return 1;
+    return 0;
+}
+
+
+// the same algorithm as build_regions, but each row is stored as a list of
+// runs of equal colour instead of a label per pixel. within a run
+// whose pixels above also belong to a single run, nothing changes, so only
+// the pixels where the colour changes in the current or previous row are
+// visited. these are found 64 pixels at a time with XOR and count trailing
+// zeros.
+static void build_regions_packed( Segmenter *s, const PackedWord *source )
+{
+    int x, y, w, bit;
+    int words = PACKED_ROW_WORDS( s->width );
+    int last_bits = s->width - (words - 1) * 64;
+    PackedWord last_mask = last_bits == 64 ? ~(PackedWord)0 : (((PackedWord)1 << last_bits) - 1);
+    SegmenterRun *current_runs = &s->runs_under_construction[0];
+    SegmenterRun *previous_runs = &s->runs_under_construction[s->width + 1];
+    int current_count, previous_count;
+    const PackedWord *current_row, *previous_row;
+
+    s->label_count = 0;
+    s->region_count = 0;
+    s->freed_regions_head = 0;
+
+    // top line
+
+    current_count = 0;
+    current_runs[current_count].start = 0;
+    current_runs[current_count].label = new_region( s, 0, 0, PACKED_COLOUR( source[0], 0 ) );
+    LABEL_REGION( s, current_runs[current_count].label )->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
+    ++current_count;
+
+    for( w = 0; w < words; ++w ){
+        PackedWord word = source[w];
+        PackedWord carry = w > 0 ? source[w-1] >> 63 : (word & 1);
+        PackedWord changes = (word ^ ((word << 1) | carry)) & (w == words - 1 ? last_mask : ~(PackedWord)0);
+
+        while( changes ){
+            int label;
+            bit = count_trailing_zeros( changes );
+            changes &= changes - 1;
+            x = w * 64 + bit;
+
+            label = new_region( s, x, 0, PACKED_COLOUR( word, bit ) );
+            LABEL_REGION( s, label )->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
+            make_adjacent( s, LABEL_REGION( s, label ), LABEL_REGION( s, current_runs[current_count-1].label ) );
+            current_runs[current_count].start = x;
+            current_runs[current_count].label = label;
+            ++current_count;
+        }
+    }
+
+    // process lines
+
+    for( y=1; y < s->height; ++y ){
+        int p = 0;
+        int above;
+        Region *above_region;
+
+        // swap previous and current rows
+        SegmenterRun *temp = previous_runs;
+        previous_runs = current_runs;
+        current_runs = temp;
+        previous_count = current_count;
+        previous_runs[previous_count].start = s->width;     // sentinel
+        current_count = 0;
+
+        current_row = source + y * words;
+        previous_row = current_row - words;
+
+        // left edge
+
+        above = previous_runs[0].label = find_label( s, previous_runs[0].label );
+        above_region = LABEL_REGION( s, above );
+        current_runs[0].start = 0;
+        if( PACKED_COLOUR( current_row[0], 0 ) == above_region->colour ){
+            current_runs[0].label = above;
+        }else{
+            current_runs[0].label = new_region( s, 0, y, PACKED_COLOUR( current_row[0], 0 ) );
+            LABEL_REGION( s, current_runs[0].label )->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
+            make_adjacent( s, LABEL_REGION( s, current_runs[0].label ), above_region );
+        }
+        current_count = 1;
+
+        // center span: visit the pixels where either row changes its colour
+
+        for( w = 0; w < words; ++w ){
+            PackedWord word = current_row[w];
+            PackedWord previous_word = previous_row[w];
+            PackedWord carry = w > 0 ? current_row[w-1] >> 63 : (word & 1);
+            PackedWord previous_carry = w > 0 ? previous_row[w-1] >> 63 : (previous_word & 1);
+            PackedWord changes = word ^ ((word << 1) | carry);
+            PackedWord events = (changes | (previous_word ^ ((previous_word << 1) | previous_carry)))
+                    & (w == words - 1 ? last_mask : ~(PackedWord)0);
+
+            while( events ){
+                SegmenterRun *run = &current_runs[current_count-1];
+                int colour;
+
+                bit = count_trailing_zeros( events );
+                events &= events - 1;
+                x = w * 64 + bit;
+                colour = PACKED_COLOUR( word, bit );
+
+                while( previous_runs[p+1].start <= x )
+                    ++p;
+                above = previous_runs[p].label = find_label( s, previous_runs[p].label );
+                above_region = LABEL_REGION( s, above );
+
+                if( !((changes >> bit) & 1) ){
+
+                    if( run->label != above && colour == above_region->colour ){
+
+                        // merge the current region into the previous one, see build_regions
+                        run->label = merge_labels( s, above, run->label );
+                    }
+
+                }else{
+
+                    Region *west = LABEL_REGION( s, run->label );
+                    if( west->right < x - 1 )
+                        west->right = (short)( x - 1 );
+
+                    current_runs[current_count].start = x;
+                    if( colour == above_region->colour ){
+                        current_runs[current_count].label = above;
+                        above_region->bottom = (short)y;
+                    }else{
+                        current_runs[current_count].label = new_region( s, x, y, colour );
+                        make_adjacent( s, LABEL_REGION( s, current_runs[current_count].label ), above_region );
+                        if( west != above_region )
+                            make_adjacent( s, LABEL_REGION( s, current_runs[current_count].label ), west );
+                    }
+                    ++current_count;
+
+                    // the west run is closed if no pixel below has its colour, see build_regions
+                    if( s->max_noise_area > 0 && y + 1 < s->height
+                            && is_noise_region( s, west, run->start, x - 1, y )
+                            && !packed_span_has_colour( current_row + words, run->start, x - 1, west->colour ) )
+                        fold_region( s, run->label, current_runs[current_count-1].label );
+                }
+            }
+        }
+
+        // right edge
+        LABEL_REGION( s, current_runs[current_count-1].label )->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
+    }
+
+    // make regions of bottom row adjacent or merge with root
+
+    for( x = 0; x < current_count; ++x ){
+        LABEL_REGION( s, find_label( s, current_runs[x].label ) )->flags |= ADJACENT_TO_ROOT_REGION_FLAG;
+    }
+
+    index_regions( s );
 }
 
 
@@ -496,8 +795,11 @@ void initialize_segmenter( Segmenter *s, int width, int height, int max_adjacent
 {
     //max_adjacent_regions += 2; //workaround for #44
     s->max_adjacent_regions = max_adjacent_regions;
-    s->region_refs = (RegionReference*)malloc( sizeof(RegionReference) * width * height );
-    s->region_ref_count = 0;
+    s->max_noise_area = 0;
+    s->label_parents = (int*)malloc( sizeof(int) * width * height );
+    s->label_sizes = (int*)malloc( sizeof(int) * width * height );
+    s->label_regions = (int*)malloc( sizeof(int) * width * height );
+    s->label_count = 0;
     s->sizeof_region = sizeof(Region) + sizeof(Region*) * (max_adjacent_regions-1);
     s->regions = (unsigned char*)malloc( s->sizeof_region * width * height );
    // s->spans = (unsigned char*)malloc(  sizeof(Span) * width * height );
@@ -506,19 +808,68 @@ void initialize_segmenter( Segmenter *s, int width, int height, int max_adjacent
 	s->width = width;
 	s->height = height;
 	
-    s->regions_under_construction = (RegionReference**)malloc( sizeof(RegionReference*) * width * 2 );
+    s->regions_under_construction = (int*)malloc( sizeof(int) * width * 2 );
+    s->runs_under_construction = (SegmenterRun*)malloc( sizeof(SegmenterRun) * (width + 1) * 2 );
+
+    s->live_regions = (int*)malloc( sizeof(int) * width * height );
+    s->live_region_count = 0;
+    s->leaf_regions = (int*)malloc( sizeof(int) * width * height );
+    s->leaf_region_count = 0;
+
+    s->stats.region_count = 0;
+    s->stats.created_region_count = 0;
+    s->stats.merged_region_count = 0;
+    s->stats.folded_region_count = 0;
+    s->stats.saturated_region_count = 0;
+    s->stats.fragmented_region_count = 0;
 }
 
 void terminate_segmenter( Segmenter *s )
 {
-    free( s->region_refs );
+    free( s->label_parents );
+    free( s->label_sizes );
+    free( s->label_regions );
     free( s->regions );
 	//free( s->spans );
     free( s->regions_under_construction );
+    free( s->runs_under_construction );
+    free( s->live_regions );
+    free( s->leaf_regions );
+}
+
+static void update_stats( Segmenter *s )
+{
+    s->stats.region_count = s->region_count;
+    s->stats.created_region_count = s->label_count;
 }
 
 void step_segmenter( Segmenter *s, const unsigned char *source )
 {
-    if( s->region_refs && s->regions && s->regions_under_construction /*&& s->spans*/) 
+    s->stats.merged_region_count = 0;
+    s->stats.folded_region_count = 0;
+    s->live_region_count = 0;
+    s->leaf_region_count = 0;
+    if( s->label_parents && s->label_sizes && s->label_regions
+            && s->regions && s->regions_under_construction /*&& s->spans*/
+            && s->live_regions && s->leaf_regions )
 		build_regions( s, source );
+    update_stats( s );
+}
+
+void step_segmenter_packed( Segmenter *s, const PackedWord *source )
+{
+    s->stats.merged_region_count = 0;
+    s->stats.folded_region_count = 0;
+    s->live_region_count = 0;
+    s->leaf_region_count = 0;
+    if( s->label_parents && s->label_sizes && s->label_regions
+            && s->regions && s->runs_under_construction
+            && s->live_regions && s->leaf_regions )
+        build_regions_packed( s, source );
+    update_stats( s );
+}
+
+void set_noise_gate( Segmenter *s, int max_area )
+{
+    s->max_noise_area = max_area;
 }
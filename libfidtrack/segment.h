@@ -71,8 +71,6 @@ extern "C"
 
 #define UNKNOWN_REGION_LEVEL            (-1)
 
-#define REGION_GATE_AREA				1
-
 typedef struct Span{
 	int start, end;
 	struct Span *next;
@@ -101,28 +99,33 @@ typedef struct Region{
 } Region;
 
 
-typedef struct RegionReference{
-    Region *region;
-    struct RegionReference *redirect;
-} RegionReference;
+/*
+    bit-packed images have one bit per pixel, which is set for white pixels.
+    each row starts with a new word, the lowest bit of a word is the leftmost
+    pixel and unused bits at the end of a row must be zero.
+*/
+typedef unsigned long long PackedWord;
 
+#define PACKED_ROW_WORDS( width )   (((width) + 63) / 64)
 
 
-//#define REGIONREF_IS_REDIRECTED(r) ((r)->redirect != (r))
+typedef struct SegmenterRun{
+    int start;
+    int label;
+} SegmenterRun;
 
 
-#define RESOLVE_REGIONREF_REDIRECTS( x, r )                                    \
-{                                                                              \
-    if( r->redirect != r ){                                                    \
-        RegionReference *result = r;										   \
-		while( result->redirect != result )								       \
-            result = result->redirect;                                         \
-        r->redirect = result;                                                  \
-        x = result;                                                            \
-    }else{                                                                     \
-        x = r;                                                                 \
-    }                                                                          \
-}
+/*
+    counters of the last step of the segmenter
+*/
+typedef struct SegmenterStats{
+    int region_count;               /* the largest number of regions in use at the same time */
+    int created_region_count;       /* regions created, including those merged into others */
+    int merged_region_count;        /* regions freed by merging them into another region */
+    int folded_region_count;        /* noise regions folded into their surrounding region */
+    int saturated_region_count;     /* live regions whose adjacency list overflowed */
+    int fragmented_region_count;    /* live regions that lost a neighbour to a saturated region */
+} SegmenterStats;
 
 
 void initialize_head_region( Region *r );
@@ -131,8 +134,17 @@ void unlink_region( Region* r );
 
 
 typedef struct Segmenter{
-    RegionReference *region_refs;
-    int region_ref_count;
+    /*
+        while a frame is segmented, every pixel of the current and previous
+        row holds an integer label. the labels of merged regions are joined in
+        a union-find forest: the parent of each label, the size of each tree
+        (the smaller tree is attached to the larger one) and, for root labels,
+        the index of the region.
+    */
+    int *label_parents;
+    int *label_sizes;
+    int *label_regions;
+    int label_count;
     unsigned char *regions;     /* buffer containing raw region ptrs */
     unsigned char *spans;		/* buffer containing raw span ptrs */
     int region_count;
@@ -140,10 +152,25 @@ typedef struct Segmenter{
 
     int sizeof_region;
     int max_adjacent_regions;
+    int max_noise_area;         /* see set_noise_gate */
 	
 	int width, height;
 
-    RegionReference **regions_under_construction;
+    int *regions_under_construction;           /* labels of the current and previous row */
+    SegmenterRun *runs_under_construction;     /* used by step_segmenter_packed */
+
+    /*
+        after each step, the indices of the live regions and of the leaf
+        regions (a single neighbour and none of the saturated, fragmented or
+        adjacent to root flags) in creation order. they are collected from the
+        root labels, so freed regions are never visited.
+    */
+    int *live_regions;
+    int live_region_count;
+    int *leaf_regions;
+    int leaf_region_count;
+
+    SegmenterStats stats;
 }Segmenter;
 
 #define LOOKUP_SEGMENTER_REGION( s, index )\
@@ -157,6 +184,22 @@ void terminate_segmenter( Segmenter *segments );
 
 void step_segmenter( Segmenter *segments, const unsigned char *source );
 
+/*
+    gives the same result as step_segmenter for a bit-packed image, but only
+    visits the pixels where the colour changes in the current or previous row
+*/
+void step_segmenter_packed( Segmenter *segments, const PackedWord *source );
+
+/*
+    noise regions are closed regions whose bounding box covers at most
+    max_area pixels and which have a single adjacent region. they are folded
+    into that region while segmenting, as if their pixels had its colour, so
+    they neither appear as leaves nor fill the adjacency lists. max_area must
+    be smaller than the leaves of the fiducials. the gate is disabled by
+    default (max_area 0).
+*/
+void set_noise_gate( Segmenter *segments, int max_area );
+
 
 #ifdef __cplusplus
 }
@@ -22,6 +22,7 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 void simple_threshold( const unsigned char *source, int source_stride,
         unsigned char *dest,
@@ -43,6 +44,142 @@ void simple_threshold( const unsigned char *source, int source_stride,
     }                            
 }
 
+// thresholds one row, eight pixels at once: a byte exceeds the threshold if
+// adding 255 - threshold carries out of it. assumes little endian byte order.
+static void threshold_packed_row( const unsigned char *p, PackedWord *d, int width, int threshold )
+{
+    const PackedWord high = 0x8080808080808080ULL;
+    const PackedWord addend = (PackedWord)(255 - threshold) * 0x0101010101010101ULL;
+    int words = PACKED_ROW_WORDS( width );
+    int x, w, bit;
+
+    for( w=0, x=0; w < words; ++w ){
+        PackedWord bits = 0;
+        int count = width - x < 64 ? width - x : 64;
+
+        for( bit=0; bit + 8 <= count; bit += 8, x += 8 ){
+            PackedWord v, carry, above;
+            memcpy( &v, p + x, 8 );
+            carry = ((v & ~high) + (addend & ~high)) & high;
+            above = ((v & addend) | (carry & (v | addend))) & high;
+            bits |= (((above >> 7) * 0x0102040810204080ULL) >> 56) << bit;
+        }
+        for( ; bit < count; ++bit, ++x ){
+            bits |= (PackedWord)(p[x] > threshold) << bit;
+        }
+        d[w] = bits;
+    }
+}
+
+void packed_threshold( const unsigned char *source, int source_row_stride,
+        PackedWord *dest,
+        int width, int height,
+        int threshold )
+{
+    int words = PACKED_ROW_WORDS( width );
+    int y;
+
+    for( y=0; y < height; ++y )
+        threshold_packed_row( source + y * source_row_stride, dest + y * words, width, threshold );
+}
+
+
+// one row of a 3x3 erosion (or dilation) of bit-packed rows, computed as a
+// vertical AND (OR) of the three rows followed by a horizontal AND (OR) of
+// each word with its shifted neighbours. pixels outside the image are
+// neutral, i.e. white for erosion and black for dilation.
+static void morphology_row( const PackedWord *above, const PackedWord *row, const PackedWord *below,
+        PackedWord *dest, int words, PackedWord last_mask, int erode )
+{
+    PackedWord fill = erode ? ~(PackedWord)0 : 0;
+    PackedWord previous = fill, current, next;
+    int w;
+
+    current = erode ? (above[0] & row[0] & below[0]) : (above[0] | row[0] | below[0]);
+    if( words == 1 )
+        current = (current & last_mask) | (fill & ~last_mask);
+
+    for( w=0; w < words; ++w ){
+        PackedWord west, east;
+
+        if( w + 1 < words ){
+            next = erode ? (above[w+1] & row[w+1] & below[w+1]) : (above[w+1] | row[w+1] | below[w+1]);
+            if( w + 2 == words )
+                next = (next & last_mask) | (fill & ~last_mask);
+        }else{
+            next = fill;
+        }
+        west = (current << 1) | (previous >> 63);
+        east = (current >> 1) | (next << 63);
+        dest[w] = erode ? (current & west & east) : (current | west | east);
+
+        previous = current;
+        current = next;
+    }
+    dest[words-1] &= last_mask;
+}
+
+
+void packed_threshold_filtered( const unsigned char *source, int source_row_stride,
+        PackedWord *dest, PackedWord *filter_buffer,
+        int width, int height,
+        int threshold, int filter )
+{
+    int words = PACKED_ROW_WORDS( width );
+    int last_bits = width - (words - 1) * 64;
+    PackedWord last_mask = last_bits == 64 ? ~(PackedWord)0 : (((PackedWord)1 << last_bits) - 1);
+    int erode[4];
+    int stages = 0;
+    PackedWord *buffer = filter_buffer, *ones, *zeros;
+    int y, k, w;
+
+    if( filter & PACKED_OPEN_FILTER ){
+        erode[stages++] = 1;
+        erode[stages++] = 0;
+    }
+    if( filter & PACKED_CLOSE_FILTER ){
+        erode[stages++] = 0;
+        erode[stages++] = 1;
+    }
+    if( stages == 0 || height < 1 ){
+        packed_threshold( source, source_row_stride, dest, width, height, threshold );
+        return;
+    }
+
+    // the input of each stage is kept in a ring of three rows, the output of
+    // the last stage is written to dest. stage k produces row y - k - 1 after
+    // row y has been thresholded, so every row is in the cache while filtered.
+    ones = buffer + 3 * stages * words;
+    zeros = ones + words;
+    for( w=0; w < words; ++w ){
+        ones[w] = ~(PackedWord)0;
+        zeros[w] = 0;
+    }
+
+#define STAGE_ROW( k, row )     (buffer + ((k) * 3 + (row) % 3) * words)
+
+    for( y=0; y < height + stages; ++y ){
+        if( y < height )
+            threshold_packed_row( source + y * source_row_stride, STAGE_ROW( 0, y ), width, threshold );
+
+        for( k=0; k < stages; ++k ){
+            int row = y - k - 1;
+            const PackedWord *neutral = erode[k] ? ones : zeros;
+
+            if( row < 0 || row >= height )
+                continue;
+            morphology_row(
+                    row > 0 ? STAGE_ROW( k, row - 1 ) : neutral,
+                    STAGE_ROW( k, row ),
+                    row + 1 < height ? STAGE_ROW( k, row + 1 ) : neutral,
+                    k + 1 < stages ? STAGE_ROW( k + 1, row ) : dest + row * words,
+                    words, last_mask, erode[k] );
+        }
+    }
+
+#undef STAGE_ROW
+}
+
 void simple_adaptive_threshold( const unsigned char *source, int source_stride,
         unsigned char *dest,
         int width, int height,
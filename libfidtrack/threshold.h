@@ -21,6 +21,8 @@
 #ifndef INCLUDED_THRESHOLD_H
 #define INCLUDED_THRESHOLD_H
 
+#include "segment.h"
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -56,6 +58,40 @@ void overlapped_adaptive_threshold( const unsigned char *source, int source_stri
         int width, int height,
         int tile_size );
 
+/*
+    packed_threshold writes a bit-packed image for step_segmenter_packed, see
+    segment.h. source is a monochrome image whose rows are source_row_stride
+    bytes apart, dest must hold PACKED_ROW_WORDS( width ) * height words.
+*/
+
+void packed_threshold( const unsigned char *source, int source_row_stride,
+        PackedWord *dest,
+        int width, int height,
+        int threshold );
+
+/*
+    packed_threshold_filtered additionally removes noise with a 3x3 opening
+    (PACKED_OPEN_FILTER, removes white specks) and/or closing
+    (PACKED_CLOSE_FILTER, fills black specks) on the bit-packed rows. when
+    both are given the image is opened first. the filters are applied to a
+    few rows at a time while thresholding, so dest is written only once.
+    structures narrower than three pixels are removed as well. the rows in
+    flight are kept in filter_buffer, which must hold
+    PACKED_FILTER_BUFFER_WORDS( width ) words and is allocated once by the
+    caller; it may be NULL when filter is 0.
+*/
+
+#define PACKED_OPEN_FILTER      (1)
+#define PACKED_CLOSE_FILTER     (2)
+
+/* three rows for each of the at most four stages plus a row of ones and zeros */
+#define PACKED_FILTER_BUFFER_WORDS( width )     (PACKED_ROW_WORDS( width ) * (3 * 4 + 2))
+
+void packed_threshold_filtered( const unsigned char *source, int source_row_stride,
+        PackedWord *dest, PackedWord *filter_buffer,
+        int width, int height,
+        int threshold, int filter );
+
 void overlapped_adaptive_threshold2( const unsigned char *source, int source_stride,
         unsigned char *dest,
         int width, int height,
@@ -0,0 +1,49 @@
+/*
+  Fiducial tracking library.
+  Copyright (C) 2004 Ross Bencina <rossb@audiomulch.com>
+  Maintainer (C) 2005-2008 Martin Kaltenbrunner <mkalten@iua.upf.edu>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/*
+    converts a text tree file with one tree per line, like all.trees, into a
+    binary tree file that initialize_treeidmap_from_file maps into memory
+    instead of parsing it:
+
+    g++ -I.. convert_tree_set.cpp ../treeidmap.cpp -o convert_tree_set
+    ./convert_tree_set ../all.trees all.ftts
+*/
+
+#include "treeidmap.h"
+
+#include <stdio.h>
+
+int main( int argc, char *argv[] )
+{
+    if( argc != 3 ){
+        printf( "usage: convert_tree_set <text tree file> <binary tree file>\n" );
+        return 1;
+    }
+
+    TreeIdMap treeidmap;
+    initialize_treeidmap_from_file( &treeidmap, argv[1] );
+    int ok = treeidmap.tree_count > 0 && write_treeidmap( &treeidmap, argv[2] );
+    if( ok )
+        printf( "%d trees with %d to %d nodes written to %s\n", treeidmap.tree_count,
+                treeidmap.min_node_count, treeidmap.max_node_count, argv[2] );
+    terminate_treeidmap( &treeidmap );
+    return ok ? 0 : 1;
+}
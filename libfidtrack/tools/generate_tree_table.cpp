@@ -0,0 +1,153 @@
+/*
+  Fiducial tracking library.
+  Copyright (C) 2004 Ross Bencina <rossb@audiomulch.com>
+  Maintainer (C) 2005-2008 Martin Kaltenbrunner <mkalten@iua.upf.edu>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/*
+    generates default_tree_table.h, the lookup table of the trees in
+    default_trees.h, so that initialize_treeidmap needs no work at runtime.
+    run it again whenever default_trees.h changes:
+
+    g++ -I.. generate_tree_table.cpp ../treeidmap.cpp -o generate_tree_table
+    ./generate_tree_table > ../default_tree_table.h
+
+    to verify that the checked in table matches default_trees.h, e.g. before
+    a release or in a continuous build, run
+
+    ./generate_tree_table --check ../default_tree_table.h
+
+    which exits with 1 and names the first differing line if it is stale.
+*/
+
+#include "treeidmap.h"
+#include "default_trees.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static void write_table( FILE *out, const TreeTable *table )
+{
+    int child_count = table->tree_count > 1 ? table->tree_count - 1 : 0;
+    char value[64];
+    int i;
+
+    fprintf( out, "/* generated by tools/generate_tree_table.cpp from default_trees.h, do not edit */\n\n" );
+    fprintf( out, "#ifndef INCLUDED_DEFAULT_TREE_TABLE_H\n" );
+    fprintf( out, "#define INCLUDED_DEFAULT_TREE_TABLE_H\n\n" );
+    fprintf( out, "#include \"treeidmap.h\"\n\n" );
+
+    // the strings are separated by the 0 at the end of each literal
+    fprintf( out, "static const char default_tree_strings[] =" );
+    for( i=0; i < table->tree_count; ++i ){
+        fprintf( out, "\n    \"%s\\0\"", table->strings + table->nodes[i].treestring );
+    }
+    fprintf( out, ";\n\n" );
+
+    fprintf( out, "static const TreeTableNode default_tree_nodes[%d] = {\n", table->tree_count );
+    for( i=0; i < table->tree_count; ++i ){
+        const TreeTableNode *node = &table->nodes[i];
+        fprintf( out, "    { %d, %d, %d, %d }%s\n", node->treestring, node->id,
+                node->first_child, node->child_count, i + 1 < table->tree_count ? "," : "" );
+    }
+    fprintf( out, "};\n\n" );
+
+    fprintf( out, "static const int default_tree_sorted_nodes[%d] = {", table->tree_count );
+    for( i=0; i < table->tree_count; ++i ){
+        fprintf( out, "%s%d%s", i % 16 == 0 ? "\n    " : " ", table->sorted_nodes[i],
+                i + 1 < table->tree_count ? "," : "" );
+    }
+    fprintf( out, "\n};\n\n" );
+
+    // every node but the root is the child of one node
+    fprintf( out, "static const TreeTableChild default_tree_children[%d] = {", child_count > 0 ? child_count : 1 );
+    for( i=0; i < child_count; ++i ){
+        fprintf( out, "%s{ %d, %d }%s", i % 8 == 0 ? "\n    " : " ", table->children[i].distance,
+                table->children[i].node, i + 1 < child_count ? "," : "" );
+    }
+    fprintf( out, child_count > 0 ? "\n};\n\n" : "\n    { 0, 0 }\n};\n\n" );
+
+    fprintf( out, "static const TreeTable default_tree_table = {\n" );
+    sprintf( value, "%d,", table->tree_count );
+    fprintf( out, "    %-16s/* tree_count */\n", value );
+    sprintf( value, "%d, %d,", table->min_node_count, table->max_node_count );
+    fprintf( out, "    %-16s/* min_node_count, max_node_count */\n", value );
+    sprintf( value, "%d, %d,", table->min_depth, table->max_depth );
+    fprintf( out, "    %-16s/* min_depth, max_depth */\n", value );
+    sprintf( value, "%d,", table->max_treestring_length );
+    fprintf( out, "    %-16s/* max_treestring_length */\n", value );
+    fprintf( out, "    default_tree_nodes,\n" );
+    fprintf( out, "    default_tree_sorted_nodes,\n" );
+    fprintf( out, "    default_tree_children,\n" );
+    fprintf( out, "    default_tree_strings,\n" );
+    sprintf( value, "%d", table->string_bytes );
+    fprintf( out, "    %-16s/* string_bytes */\n", value );
+    fprintf( out, "};\n\n" );
+
+    fprintf( out, "#endif /* INCLUDED_DEFAULT_TREE_TABLE_H */\n" );
+}
+
+// compares the table generated from default_trees.h with the given file
+static int check_table( const char *file_name, const TreeTable *table )
+{
+    FILE *generated = tmpfile();
+    FILE *file = fopen( file_name, "r" );
+    char expected[1024], actual[1024];
+    int line = 0, result = 0;
+
+    if( !generated || !file ){
+        fprintf( stderr, "error opening %s\n", generated ? file_name : "temporary file" );
+        result = 2;
+    }else{
+        write_table( generated, table );
+        rewind( generated );
+        for( ;; ){
+            char *e = fgets( expected, sizeof(expected), generated );
+            char *a = fgets( actual, sizeof(actual), file );
+            ++line;
+            if( !e && !a )
+                break;
+            if( !e || !a || strcmp( e, a ) != 0 ){
+                fprintf( stderr, "%s:%d: differs from the table of default_trees.h, "
+                        "regenerate it with generate_tree_table\n", file_name, line );
+                result = 1;
+                break;
+            }
+        }
+    }
+
+    if( generated )
+        fclose( generated );
+    if( file )
+        fclose( file );
+    return result;
+}
+
+int main( int argc, char *argv[] )
+{
+    TreeIdMap treeidmap;
+    int result = 0;
+
+    initialize_treeidmap_from_strings( &treeidmap, default_tree, default_tree_length );
+    if( argc == 3 && strcmp( argv[1], "--check" ) == 0 )
+        result = check_table( argv[2], treeidmap.table );
+    else
+        write_table( stdout, treeidmap.table );
+
+    terminate_treeidmap( &treeidmap );
+    return result;
+}
@@ -19,20 +19,60 @@
 */
 
 #include "treeidmap.h"
-#include "default_trees.h"
+#include "default_tree_table.h"
 
 #include <string.h>
 #include <assert.h>
-#include <map>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <stdio.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
-static int find_maximum_tree_depth( const std::string& s )
+/*
+    binary tree files contain the TreeTable of a tree set, so that they can be
+    used without parsing once they are mapped into memory. all numbers are 32
+    bit integers in the byte order of the machine that wrote the file:
+
+    header:   "FTTS", version, tree_count, min_node_count, max_node_count,
+              min_depth, max_depth, max_treestring_length, child_count,
+              string_bytes
+    nodes:    for each tree: tree string offset, id, first child, child count
+    sorted:   for each tree: node index in the order of the tree strings
+    children: for each child: distance, node index
+    strings:  the 0 terminated tree strings
+*/
+static const char BINARY_MAGIC[4] = { 'F', 'T', 'T', 'S' };
+static const int BINARY_VERSION = 1;
+
+struct BinaryHeader{
+    char magic[4];
+    int version;
+    int tree_count;
+    int min_node_count, max_node_count;
+    int min_depth, max_depth;
+    int max_treestring_length;
+    int child_count;
+    int string_bytes;
+};
+
+static int find_maximum_tree_depth( const char *s )
 {
     int result = 0;
-    for( int i=1; i < (int)s.size(); ++i ){ // skip first character which is the black/white flag
+    for( int i=1; s[0] && s[i]; ++i ){ // skip first character which is the black/white flag
 
         int d = s[i] - '0';
         if( d > result )
@@ -77,31 +117,376 @@ static int find_maximum_descendent_count( const std::string& s )
 */
 
 
-class TreeIdMapImplementation{
-    TreeIdMap* owner_;
+// the Levenshtein distance of two tree strings. rows has room for
+// 2 * (strlen(b) + 1) entries.
+static int edit_distance( const char *a, const char *b, int *rows )
+{
+    int n = (int)strlen( b );
+    int *previous = rows;
+    int *current = rows + n + 1;
+
+    for( int j=0; j <= n; ++j )
+        previous[j] = j;
+    for( int i=1; a[i-1]; ++i ){
+        current[0] = i;
+        for( int j=1; j <= n; ++j ){
+            int d = previous[j-1] + (a[i-1] != b[j-1] ? 1 : 0);
+            if( previous[j] + 1 < d )
+                d = previous[j] + 1;
+            if( current[j-1] + 1 < d )
+                d = current[j-1] + 1;
+            current[j] = d;
+        }
+        std::swap( previous, current );
+    }
+    return previous[n];
+}
+
+
+// the scratch buffers of the lookups are on the stack for tables up to this
+// size, so that the default trees are looked up without heap allocations
+#define STACK_TREE_COUNT        256
+#define STACK_TREESTRING_LENGTH 64
+
+static int table_lookup( const TreeTable *table, const char *treestring )
+{
+    int low = 0;
+    int high = table->tree_count - 1;
+
+    while( low <= high ){
+        int middle = (low + high) / 2;
+        const TreeTableNode *node = &table->nodes[ table->sorted_nodes[middle] ];
+        int c = strcmp( treestring, table->strings + node->treestring );
+        if( c == 0 )
+            return node->id;
+        else if( c < 0 )
+            high = middle - 1;
+        else
+            low = middle + 1;
+    }
+    return INVALID_TREE_ID;
+}
+
+static int table_nearest( const TreeTable *table, const char *treestring, int max_distance,
+        int preferred_id, int *budget )
+{
+    int result = INVALID_TREE_ID;
+    int result_distance = max_distance + 1;
+    int radius = max_distance;
+
+    int pending_buffer[ STACK_TREE_COUNT ];
+    int rows_buffer[ 2 * (STACK_TREESTRING_LENGTH + 1) ];
+    std::vector<int> pending_heap, rows_heap;
+    int *pending = pending_buffer;
+    int *rows = rows_buffer;
+    if( table->tree_count > STACK_TREE_COUNT ){
+        pending_heap.resize( table->tree_count );
+        pending = &pending_heap[0];
+    }
+    if( table->max_treestring_length > STACK_TREESTRING_LENGTH ){
+        rows_heap.resize( 2 * (table->max_treestring_length + 1) );
+        rows = &rows_heap[0];
+    }
+
+    // each node is pending at most once
+    int pending_count = 0;
+    if( table->tree_count > 0 )
+        pending[ pending_count++ ] = 0;
+
+    while( pending_count > 0 && radius >= 0 && *budget > 0 ){
+        const TreeTableNode *node = &table->nodes[ pending[ --pending_count ] ];
+        --*budget;
+
+        const char *node_treestring = table->strings + node->treestring;
+        int d = edit_distance( treestring, node_treestring, rows );
+        if( node_treestring[0] == treestring[0]
+                && (d < result_distance || (d == result_distance && node->id == preferred_id)) ){
+            result = node->id;
+            result_distance = d;
+            // from now on only closer trees are of interest, and the
+            // preferred tree if it is as close
+            radius = (preferred_id == INVALID_TREE_ID || node->id == preferred_id) ? d - 1 : d;
+        }
+
+        // by the triangle inequality, trees within the radius can only be
+        // found below children whose distance differs by at most the radius
+        for( int i=0; i < node->child_count && pending_count < table->tree_count; ++i ){
+            const TreeTableChild *child = &table->children[ node->first_child + i ];
+            if( child->distance >= d - radius && child->distance <= d + radius )
+                pending[ pending_count++ ] = child->node;
+        }
+    }
+
+    return result;
+}
 
-    struct charstar_less{
-        bool operator()( const char *lhs, const char *rhs ) const
+
+// builds the table of a tree set at runtime, or maps a binary tree file
+class TreeIdMapImplementation{
+    TreeTable table_;
+    std::vector< char > strings_;
+    std::vector< TreeTableNode > nodes_;
+    std::vector< int > sortedNodes_;
+    std::vector< TreeTableChild > children_;
+
+    // the children of each node while the BK-tree is built
+    std::vector< std::vector< TreeTableChild > > nodeChildren_;
+    std::vector< int > rows_;
+
+    // the mapped binary tree file, if any
+    const char *mapping_;
+    size_t mappingSize_;
+
+    struct node_less{
+        const std::vector< TreeTableNode >& nodes;
+        const char *strings;
+        node_less( const std::vector< TreeTableNode >& n, const char *s ) : nodes( n ), strings( s ) {}
+        bool operator()( int lhs, int rhs ) const
         {
-            return strcmp( lhs, rhs ) < 0;
+            return strcmp( strings + nodes[lhs].treestring, strings + nodes[rhs].treestring ) < 0;
         }
     };
 
-    typedef std::map<const char*, int, charstar_less> map_type;
-    map_type treeIdMap_;
+    const char *treestring( int node ) const
+    {
+        return &strings_[ nodes_[node].treestring ];
+    }
+
+    // returns false if the tree is already in the set
+    bool add_tree( const std::string& s, int id )
+    {
+        int added = (int)nodes_.size();
+        int current = 0;
+        rows_.resize( 2 * (s.size() + 1) );
+
+        while( current < added ){
+            // the children of a node must be at different distances from it
+            int d = edit_distance( treestring( current ), s.c_str(), &rows_[0] );
+            if( d == 0 )
+                return false;
+
+            std::vector< TreeTableChild >& children = nodeChildren_[current];
+            size_t i = 0;
+            while( i < children.size() && children[i].distance != d )
+                ++i;
+            if( i == children.size() ){
+                TreeTableChild child;
+                child.distance = d;
+                child.node = added;
+                children.push_back( child );
+                break;
+            }
+            current = children[i].node;
+        }
+
+        TreeTableNode node;
+        node.treestring = (int)strings_.size();
+        strings_.insert( strings_.end(), s.c_str(), s.c_str() + s.size() + 1 );
+        node.id = id;
+        node.first_child = 0;
+        node.child_count = 0;
+        nodes_.push_back( node );
+        nodeChildren_.push_back( std::vector< TreeTableChild >() );
+        return true;
+    }
 
-    std::vector< const char *> strings_;
+    void add_tree_or_report( const std::string& s, int id )
+    {
+        if( !add_tree( s, id ) )
+            std::cout << "error inserting tree '" << s << "' into map\n";
+    }
 
-public:
-    TreeIdMapImplementation( TreeIdMap* treeidmap, const char *file_name )
-        : owner_( treeidmap )
+    // flattens the BK-tree and computes the bounds of the set
+    void finish()
+    {
+        int count = (int)nodes_.size();
+
+        table_.min_node_count = 0x7FFF;
+        table_.max_node_count = 0;
+        table_.min_depth = 0x7FFF;
+        table_.max_depth = 0;
+        table_.max_treestring_length = 0;
+
+        for( int i=0; i < count; ++i ){
+            TreeTableNode& node = nodes_[i];
+            node.first_child = (int)children_.size();
+            node.child_count = (int)nodeChildren_[i].size();
+            children_.insert( children_.end(), nodeChildren_[i].begin(), nodeChildren_[i].end() );
+            sortedNodes_.push_back( i );
+
+            std::string s( treestring( i ) );
+            int depthSequenceLength = (int)( s.size() - 1 );
+            int maxTreeDepth = find_maximum_tree_depth( s.c_str() );
+
+            table_.min_node_count = std::min( table_.min_node_count, depthSequenceLength );
+            table_.max_node_count = std::max( table_.max_node_count, depthSequenceLength );
+            table_.min_depth = std::min( table_.min_depth, maxTreeDepth );
+            table_.max_depth = std::max( table_.max_depth, maxTreeDepth );
+            table_.max_treestring_length = std::max( table_.max_treestring_length, (int)s.size() );
+        }
+        std::sort( sortedNodes_.begin(), sortedNodes_.end(), node_less( nodes_, strings_.empty() ? 0 : &strings_[0] ) );
+        nodeChildren_.clear();
+
+        if( count == 0 ){
+            table_.min_node_count = 0;
+            table_.min_depth = 0;
+        }
+        table_.tree_count = count;
+        table_.nodes = count ? &nodes_[0] : 0;
+        table_.sorted_nodes = count ? &sortedNodes_[0] : 0;
+        table_.children = children_.empty() ? 0 : &children_[0];
+        table_.strings = strings_.empty() ? 0 : &strings_[0];
+        table_.string_bytes = (int)strings_.size();
+    }
+
+    // checks every offset and index of a mapped table against its section, so
+    // that a corrupt file can't make the lookups read outside the mapping, and
+    // the bounds of the set against its trees, since they size the buffers of
+    // the segmenter and the tracker. this visits each node once but neither
+    // parses nor allocates.
+    static bool valid_table( const TreeTable& table, int child_count )
+    {
+        // the bounds as computed by finish()
+        int min_node_count = table.tree_count ? 0x7FFF : 0, max_node_count = 0;
+        int min_depth = table.tree_count ? 0x7FFF : 0, max_depth = 0;
+        int max_treestring_length = 0;
+
+        for( int i=0; i < table.tree_count; ++i ){
+            const TreeTableNode& node = table.nodes[i];
+            if( node.treestring < 0 || node.treestring >= table.string_bytes || node.id < 0
+                    || node.first_child < 0 || node.child_count < 0
+                    || node.child_count > child_count - node.first_child )
+                return false;
+            if( table.sorted_nodes[i] < 0 || table.sorted_nodes[i] >= table.tree_count )
+                return false;
+
+            // the strings section ends with a 0, so strlen stays inside it
+            const char *s = table.strings + node.treestring;
+            int length = (int)strlen( s );
+            int depth = find_maximum_tree_depth( s );
+            min_node_count = std::min( min_node_count, length - 1 );
+            max_node_count = std::max( max_node_count, length - 1 );
+            min_depth = std::min( min_depth, depth );
+            max_depth = std::max( max_depth, depth );
+            max_treestring_length = std::max( max_treestring_length, length );
+        }
+        for( int i=0; i < child_count; ++i ){
+            if( table.children[i].node < 0 || table.children[i].node >= table.tree_count )
+                return false;
+        }
+        return table.min_node_count == min_node_count && table.max_node_count == max_node_count
+                && table.min_depth == min_depth && table.max_depth == max_depth
+                && table.max_treestring_length == max_treestring_length;
+    }
+
+    // maps the file and points the table into it, if it is a binary tree file.
+    // a file that is not consistent is rejected, leaving the set empty.
+    bool map_binary_file( const char *file_name )
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileA( file_name, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL, 0 );
+        if( file == INVALID_HANDLE_VALUE )
+            return false;
+        LARGE_INTEGER size;
+        HANDLE mapping = 0;
+        if( GetFileSizeEx( file, &size ) && size.QuadPart >= (LONGLONG)sizeof(BinaryHeader) )
+            mapping = CreateFileMappingA( file, 0, PAGE_READONLY, 0, 0, 0 );
+        if( mapping ){
+            mapping_ = (const char*)MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+            mappingSize_ = mapping_ ? (size_t)size.QuadPart : 0;
+            CloseHandle( mapping );
+        }
+        CloseHandle( file );
+#else
+        int file = open( file_name, O_RDONLY );
+        if( file < 0 )
+            return false;
+        struct stat status;
+        if( fstat( file, &status ) == 0 && status.st_size >= (off_t)sizeof(BinaryHeader) ){
+            void *mapping = mmap( 0, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0 );
+            if( mapping != MAP_FAILED ){
+                mapping_ = (const char*)mapping;
+                mappingSize_ = (size_t)status.st_size;
+            }
+        }
+        close( file );
+#endif
+        if( !mapping_ )
+            return false;
+
+        const BinaryHeader *header = (const BinaryHeader*)mapping_;
+        if( memcmp( header->magic, BINARY_MAGIC, sizeof(BINARY_MAGIC) ) != 0 ){
+            unmap();
+            return false;
+        }
+
+        // the sections follow the header without padding. each count is checked
+        // against the mapping before it is multiplied, so that the offsets can't
+        // wrap around where size_t has 32 bits
+        size_t nodes = sizeof(BinaryHeader);
+        size_t sorted = 0, children = 0, strings = 0;
+        bool sizes_valid = header->tree_count >= 0 && header->child_count >= 0 && header->string_bytes >= 0
+                && (size_t)header->tree_count <= (mappingSize_ - nodes) / sizeof(TreeTableNode);
+        if( sizes_valid ){
+            sorted = nodes + (size_t)header->tree_count * sizeof(TreeTableNode);
+            sizes_valid = (size_t)header->tree_count <= (mappingSize_ - sorted) / sizeof(int);
+        }
+        if( sizes_valid ){
+            children = sorted + (size_t)header->tree_count * sizeof(int);
+            sizes_valid = (size_t)header->child_count <= (mappingSize_ - children) / sizeof(TreeTableChild);
+        }
+        if( sizes_valid ){
+            strings = children + (size_t)header->child_count * sizeof(TreeTableChild);
+            sizes_valid = (size_t)header->string_bytes == mappingSize_ - strings;
+        }
+        if( header->version != BINARY_VERSION || !sizes_valid
+                || (header->tree_count > 0 && header->string_bytes == 0)
+                || (header->string_bytes > 0 && mapping_[ mappingSize_ - 1 ] != '\0') ){
+            std::cout << "error reading binary tree file: " << file_name << std::endl;
+            unmap();
+            finish();
+            return true;
+        }
+
+        table_.tree_count = header->tree_count;
+        table_.min_node_count = header->min_node_count;
+        table_.max_node_count = header->max_node_count;
+        table_.min_depth = header->min_depth;
+        table_.max_depth = header->max_depth;
+        table_.max_treestring_length = header->max_treestring_length;
+        table_.nodes = (const TreeTableNode*)( mapping_ + nodes );
+        table_.sorted_nodes = (const int*)( mapping_ + sorted );
+        table_.children = (const TreeTableChild*)( mapping_ + children );
+        table_.strings = mapping_ + strings;
+        table_.string_bytes = header->string_bytes;
+        if( !valid_table( table_, header->child_count ) ){
+            std::cout << "error reading binary tree file: " << file_name << std::endl;
+            unmap();
+            finish();
+        }
+        return true;
+    }
+
+    void unmap()
     {
+        if( mapping_ ){
+#ifdef _WIN32
+            UnmapViewOfFile( mapping_ );
+#else
+            munmap( (void*)mapping_, mappingSize_ );
+#endif
+            mapping_ = 0;
+            mappingSize_ = 0;
+        }
+    }
 
-        int minNodeCount = 0;
-        int maxNodeCount = 0;
-        int minDepth = 0;
-        int maxDepth = 0;
-        int maxAdjacencies = 0;
+public:
+    TreeIdMapImplementation( const char *file_name )
+        : mapping_( 0 ), mappingSize_( 0 )
+    {
+        if( map_binary_file( file_name ) )
+            return;
 
         std::ifstream is( file_name );
         std::string s;
@@ -110,9 +495,6 @@ public:
         if( !is.good() ){
             std::cout << "error opening tree file: " << file_name << std::endl;
         }else{
-		
-     	    minNodeCount = 0x7FFF;
-            minDepth = 0x7FFF;
             while( !is.eof() ){
 
                 s.clear();
@@ -120,149 +502,119 @@ public:
                 if( s.empty() )
                     continue;
 
-                int depthSequenceLength;
-
                 // ensure that the depth sequence has a root colour prefix
                 // of 'w' (white) or 'b' (black). if not, prepend one.
-                if( s[0] == 'w' || s[0] == 'b' ){
-                    depthSequenceLength = (int)( s.size() - 1 );
-                }else{
-                    depthSequenceLength = (int)( s.size() );
+                if( s[0] != 'w' && s[0] != 'b' )
                     s = 'w' + s;
-                }
-
-                char *ss = new char[ s.size() + 1 ];
-                strings_.push_back( ss );
-                strcpy( ss, s.c_str() );
-                std::pair<map_type::iterator, bool> i = treeIdMap_.insert( std::make_pair( ss, id++ ) );
-                if( i.second ){
-
-                    if( depthSequenceLength < minNodeCount )
-                        minNodeCount = depthSequenceLength;
-                    if( depthSequenceLength > maxNodeCount )
-                        maxNodeCount = depthSequenceLength;
-
-                    int maxTreeDepth = find_maximum_tree_depth( s );
-
-                    if( maxTreeDepth < minDepth )
-                        minDepth = maxTreeDepth;
-                    if( maxTreeDepth > maxDepth )
-                        maxDepth = maxTreeDepth;
-/*
-                    int maxNodeAdjacencies = find_maximum_descendent_count( s ) + 1;
-                    if( maxNodeAdjacencies > maxAdjacencies )
-                        maxAdjacencies = maxNodeAdjacencies;
-*/
-                }else{
-                    std::cout << "error inserting tree '" << s << "' into map\n";
-                }
-
 
+                add_tree_or_report( s, id++ );
             }
         }
 
-		maxAdjacencies = maxNodeCount;
-        owner_->tree_count = treeIdMap_.size();
-        owner_->min_node_count = minNodeCount;
-        owner_->max_node_count = maxNodeCount;
-        owner_->min_depth = minDepth;
-        owner_->max_depth = maxDepth;
-        owner_->max_adjacencies = maxAdjacencies;
-		
-		//std::cout << minNodeCount << " " << maxNodeCount << " " << minDepth << " " << maxDepth << " " << maxAdjacencies << std::endl;
-
+        finish();
     }
 
-
-    TreeIdMapImplementation( TreeIdMap* treeidmap )
-        : owner_( treeidmap )
+    TreeIdMapImplementation( const char * const *treestrings, int count )
+        : mapping_( 0 ), mappingSize_( 0 )
     {
+        for( int id=0; id < count; ++id )
+            add_tree_or_report( treestrings[id], id );
 
-        int minNodeCount = 0x7FFF;
-        int maxNodeCount = 0;
-        int minDepth = 0x7FFF;
-        int maxDepth = 0;
-        int maxAdjacencies = 0;
-
-        int id = 0;
-
-        for (int j=0;j<default_tree_length;j++) {
-
-		std::string s(default_tree[j]);
-
-                int depthSequenceLength = (int)( s.size() - 1 );
-
-                char *ss = new char[ s.size() + 1 ];
-                strings_.push_back( ss );
-                strcpy( ss, s.c_str() );
-                std::pair<map_type::iterator, bool> i = treeIdMap_.insert( std::make_pair( ss, id++ ) );
-                if( i.second ){
-                    if( depthSequenceLength < minNodeCount )
-                        minNodeCount = depthSequenceLength;
-                    if( depthSequenceLength > maxNodeCount )
-                        maxNodeCount = depthSequenceLength;
-
-                    int maxTreeDepth = find_maximum_tree_depth( s );
-
-                    if( maxTreeDepth < minDepth )
-                        minDepth = maxTreeDepth;
-                    if( maxTreeDepth > maxDepth )
-                        maxDepth = maxTreeDepth;
-
-					/*
-                    int maxNodeAdjacencies = find_maximum_descendent_count( s ) + 1;
-                    if( maxNodeAdjacencies > maxAdjacencies )
-                        maxAdjacencies = maxNodeAdjacencies;
-					*/
-                }else{
-                    std::cout << "error inserting tree '" << s << "' into map\n";
-            }
-        }
-
-		maxAdjacencies = maxNodeCount;
-		owner_->tree_count = treeIdMap_.size();
-        owner_->min_node_count = minNodeCount;
-        owner_->max_node_count = maxNodeCount;
-        owner_->min_depth = minDepth;
-        owner_->max_depth = maxDepth;
-        owner_->max_adjacencies = maxAdjacencies;
+        finish();
     }
 
-
     ~TreeIdMapImplementation()
     {
-        while( !strings_.empty() ){
-            delete [] strings_.back();
-            strings_.pop_back();
-        }
+        unmap();
     }
 
-    int treestring_to_id( const char *treestring )
+    const TreeTable *table() const
     {
-        map_type::iterator i = treeIdMap_.find( treestring );
-        if( i != treeIdMap_.end() ) return i->second;
-        else  return INVALID_TREE_ID;
+        return &table_;
     }
 };
 
+
+static void set_table( TreeIdMap* treeidmap, const TreeTable *table )
+{
+    treeidmap->table = table;
+    treeidmap->tree_count = table->tree_count;
+    treeidmap->min_node_count = table->min_node_count;
+    treeidmap->max_node_count = table->max_node_count;
+    treeidmap->min_depth = table->min_depth;
+    treeidmap->max_depth = table->max_depth;
+    treeidmap->max_adjacencies = table->max_node_count;
+}
+
 void initialize_treeidmap_from_file( TreeIdMap* treeidmap, const char *file_name )
 {
-    treeidmap->implementation_ = new TreeIdMapImplementation( treeidmap, file_name );
+    TreeIdMapImplementation *implementation = new TreeIdMapImplementation( file_name );
+    treeidmap->implementation_ = implementation;
+    set_table( treeidmap, implementation->table() );
+}
+
+void initialize_treeidmap_from_strings( TreeIdMap* treeidmap, const char * const *treestrings, int count )
+{
+    TreeIdMapImplementation *implementation = new TreeIdMapImplementation( treestrings, count );
+    treeidmap->implementation_ = implementation;
+    set_table( treeidmap, implementation->table() );
 }
 
+// the default trees need neither heap memory nor initialization
 void initialize_treeidmap( TreeIdMap* treeidmap )
 {
-    treeidmap->implementation_ = new TreeIdMapImplementation( treeidmap );
+    treeidmap->implementation_ = 0;
+    set_table( treeidmap, &default_tree_table );
 }
 
 void terminate_treeidmap( TreeIdMap* treeidmap )
 {
     delete (TreeIdMapImplementation*)treeidmap->implementation_;
     treeidmap->implementation_ = 0;
+    treeidmap->table = 0;
+}
+
+int write_treeidmap( TreeIdMap* treeidmap, const char *file_name )
+{
+    const TreeTable *table = treeidmap->table;
+    FILE *file = fopen( file_name, "wb" );
+    if( !file ){
+        std::cout << "error opening binary tree file: " << file_name << std::endl;
+        return 0;
+    }
+
+    BinaryHeader header;
+    memcpy( header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC) );
+    header.version = BINARY_VERSION;
+    header.tree_count = table->tree_count;
+    header.min_node_count = table->min_node_count;
+    header.max_node_count = table->max_node_count;
+    header.min_depth = table->min_depth;
+    header.max_depth = table->max_depth;
+    header.max_treestring_length = table->max_treestring_length;
+    // every node but the root is the child of one node
+    header.child_count = table->tree_count > 1 ? table->tree_count - 1 : 0;
+    header.string_bytes = table->string_bytes;
+
+    bool ok = fwrite( &header, sizeof(header), 1, file ) == 1
+            && fwrite( table->nodes, sizeof(TreeTableNode), header.tree_count, file ) == (size_t)header.tree_count
+            && fwrite( table->sorted_nodes, sizeof(int), header.tree_count, file ) == (size_t)header.tree_count
+            && fwrite( table->children, sizeof(TreeTableChild), header.child_count, file ) == (size_t)header.child_count
+            && fwrite( table->strings, 1, header.string_bytes, file ) == (size_t)header.string_bytes;
+    ok = fclose( file ) == 0 && ok;
+    if( !ok )
+        std::cout << "error writing binary tree file: " << file_name << std::endl;
+    return ok ? 1 : 0;
 }
 
 // returns -1 for unfound id
 int treestring_to_id( TreeIdMap* treeidmap, const char *treestring )
 {
-    return ((TreeIdMapImplementation*)treeidmap->implementation_)->treestring_to_id( treestring );
+    return table_lookup( treeidmap->table, treestring );
+}
+
+int treestring_to_nearest_id( TreeIdMap* treeidmap, const char *treestring, int max_distance,
+        int preferred_id, int *budget )
+{
+    return table_nearest( treeidmap->table, treestring, max_distance, preferred_id, budget );
 }
@@ -26,8 +26,42 @@ extern "C"
 {
 #endif /* __cplusplus */
 
+/*
+    the read-only lookup structures of a tree set. the tree strings include
+    the colour prefix. the trees also form a BK-tree for approximate lookups:
+    each child of a node has a different edit distance to the node, and node 0
+    is the root. the table of the default trees is generated at build time
+    into default_tree_table.h, see tools/generate_tree_table.cpp. the table
+    contains no pointers apart from those in TreeTable, so that binary tree
+    files can be mapped into memory as they are, see write_treeidmap.
+*/
+typedef struct TreeTableNode{
+    int treestring;                 /* offset in TreeTable.strings */
+    int id;
+    int first_child, child_count;   /* range in TreeTable.children */
+} TreeTableNode;
+
+typedef struct TreeTableChild{
+    int distance;                   /* edit distance of the child to its parent */
+    int node;
+} TreeTableChild;
+
+typedef struct TreeTable{
+    int tree_count;
+    int min_node_count, max_node_count;
+    int min_depth, max_depth;
+    int max_treestring_length;
+
+    const TreeTableNode *nodes;
+    const int *sorted_nodes;        /* node indices in the order of their tree strings */
+    const TreeTableChild *children;
+    const char *strings;            /* the 0 terminated tree strings */
+    int string_bytes;
+} TreeTable;
+
 typedef struct TreeIdMap{
-    void *implementation_;
+    void *implementation_;          /* owns the table of tree files, 0 for the default trees */
+    const TreeTable *table;
 
     int tree_count;
     int min_node_count, max_node_count;
@@ -37,11 +71,20 @@ typedef struct TreeIdMap{
 
 }TreeIdMap;
 
+// reads a text file with one tree per line, or maps a binary tree file
+// written by write_treeidmap into memory
 void initialize_treeidmap_from_file( TreeIdMap* treeidmap, const char *file_name );
 void initialize_treeidmap( TreeIdMap* treeidmap );
+// builds the table of the given tree strings at runtime, the strings are copied
+void initialize_treeidmap_from_strings( TreeIdMap* treeidmap, const char * const *treestrings, int count );
 
 void terminate_treeidmap( TreeIdMap* treeidmap );
 
+// writes the table of the tree set to a binary tree file, which loads
+// without parsing and is shared by all processes using it. the file can only
+// be read on machines with the same byte order. returns 0 on failure.
+int write_treeidmap( TreeIdMap* treeidmap, const char *file_name );
+
 #define INVALID_TREE_ID     (-1)
 //#define FINGER_COUNT  (2)
 //#define FINGER_ID  (-10)
@@ -50,6 +93,15 @@ void terminate_treeidmap( TreeIdMap* treeidmap );
 // returns INVALID_TREE_ID for unfound id
 int treestring_to_id( TreeIdMap* treeidmap, const char *treestring );
 
+// returns the id of the tree with the smallest edit distance to treestring,
+// if that distance is at most max_distance and both trees have the same root
+// colour, otherwise INVALID_TREE_ID. of several equally close trees, the one
+// with preferred_id is returned (can be INVALID_TREE_ID). the trees are kept
+// in a BK-tree, and each tree compared with treestring decrements *budget. the
+// search stops when it reaches 0 and returns the closest tree found so far.
+int treestring_to_nearest_id( TreeIdMap* treeidmap, const char *treestring, int max_distance,
+        int preferred_id, int *budget );
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,50 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Automatic adaption of the threshold to changing lighting conditions
+
+#pragma once
+
+#include "stdafx.h"
+
+// Computes the threshold from a subsampled histogram of each frame with Otsu's method.
+// An additional offset is searched for when fiducials are seen, but their ids cannot be
+// recognized: the offset range is swept once, and the offset with the most recognized ids
+// is kept. Small changes of the threshold are suppressed to keep it stable.
+class ThresholdController {
+public:
+	ThresholdController();
+
+	// Compute the threshold for the given grayscale image, starting from the current threshold.
+	int computeThreshold(cv::InputArray grayScale, int currentThreshold);
+	// Report the number of fiducial candidates and the number of candidates with a valid id
+	// found with the last computed threshold.
+	void reportDetections(int candidates, int valid);
+
+private:
+	int histogram[256];
+	float smoothedThreshold;
+	int offset;
+	bool offsetChanged;
+	int emptyFrames;
+	// The state of the offset search
+	bool searching;
+	int searchStart;
+	int searchDirection;
+	int searchFrames;
+	int bestOffset;
+	int bestValid;
+	int bestLost;
+	// The valid and unrecognized candidates after the last search, a new search is only started
+	// when fewer are valid or more are unrecognized
+	int settledValid;
+	int settledLost;
+
+	void computeHistogram(const cv::Mat &image);
+	int otsuThreshold(int sampleCount);
+};
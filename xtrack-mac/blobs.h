@@ -0,0 +1,78 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Tracking of untagged objects as blobs of the contrast image
+
+#pragma once
+
+#include "stdafx.h"
+
+// The number of blobs found in a frame at most
+#define MAX_BLOBS 64
+
+// A blob found in one frame, in pixels of the full frame
+struct Blob {
+	float x;
+	float y;
+	float width;
+	float height;
+	float area;
+};
+
+// A blob tracked over several frames. Positions and sizes are relative to the frame size, speeds are
+// given per second.
+struct TrackedBlob {
+	int sessionId;
+	float x;
+	float y;
+	float width;
+	float height;
+	float area;
+	float xspeed;
+	float yspeed;
+	float xyacc;
+};
+
+// Associates the blobs of each frame with the blobs of the previous frame, pairing the closest blobs
+// first. The previous blobs are indexed in a grid whose cells have the maximum distance as side
+// length, so that each new blob is only compared with the blobs in the 3x3 cells around it.
+class BlobTracker {
+public:
+	BlobTracker();
+
+	// Blobs that moved farther than this number of frame pixels between two frames get a new session.
+	void setMaxDistance(int maxDistance);
+	// Replace the tracked blobs with the given blobs of a new frame.
+	void update(const Blob blobs[], int count, cv::Size fsize, double timestamp);
+	// The blobs tracked in the last frame
+	const std::vector<TrackedBlob> &trackedBlobs();
+
+private:
+	// A possible association of a new blob with a tracked blob
+	struct BlobPair {
+		float distance;
+		int blob;
+		int tracked;
+
+		bool operator<(const BlobPair &other) const {
+			return distance < other.distance;
+		}
+	};
+
+	int maxDistance;
+	int nextSessionId;
+	double timestamp;
+	std::vector<TrackedBlob> tracked;
+	std::vector<TrackedBlob> updated;
+	// The tracked blobs of grid cell i are cellBlobs[cellStarts[i]] to cellBlobs[cellStarts[i + 1] - 1]
+	std::vector<int> cellStarts;
+	std::vector<int> cellBlobs;
+	std::vector<BlobPair> pairs;
+	std::vector<int> matches;
+	std::vector<bool> trackedMatched;
+};
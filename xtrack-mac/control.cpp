@@ -0,0 +1,279 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Receiving OSC messages for changing parameters at runtime using WOscLib (http://wosclib.sourceforge.net/)
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "control.h"
+#include "WOscReceiverMethod.h"
+
+#define OSC_CONTAINER "xtrack"
+#define OSC_STATUS_PATH "/xtrack/status"
+#define OSC_DIAGNOSTICS_PATH "/xtrack/diagnostics"
+
+// The maximal size of received UDP packets
+static const int MAX_PACKET_SIZE = 4096;
+// The time in milliseconds after which the receiver thread checks whether it shall stop
+static const int RECEIVE_TIMEOUT = 100;
+
+enum ControlMethodType {
+	METHOD_THRESHOLD, METHOD_AUTO_THRESHOLD, METHOD_ROTATE, METHOD_ARENA_RADIUS, METHOD_TRACK_RECT_SIZE,
+	METHOD_PRINT, METHOD_ROI, METHOD_RECORD, METHOD_QUIT, METHOD_STATUS,
+	METHOD_DIAGNOSTICS
+};
+
+// The sender of a received message, used for replies
+class ControlReturnAddress : public WOscNetReturn {
+public:
+	struct sockaddr_in addr;
+};
+
+// An entry of the OSC address space, which passes messages to the control server
+class ControlMethod : public WOscReceiverMethod {
+public:
+	ControlMethod(WOscContainer *parent, ControlServer *server, int type, const char *name, const char *description)
+		: WOscReceiverMethod(parent, server, name, description), server(server), type(type) {
+	}
+
+	void Method(const WOscMessage *message, const WOscTimeTag &when, const WOscNetReturn *networkReturnAddress) {
+		server->handleMessage(type, message, networkReturnAddress);
+	}
+
+private:
+	ControlServer *server;
+	int type;
+};
+
+// Read the given number of integer or floating point arguments from the message.
+static bool getNumbers(const WOscMessage *msg, int values[], int count) {
+	if (msg->GetNumInts() == count) {
+		for (int i = 0; i < count; i++) {
+			values[i] = msg->GetInt(i);
+		}
+		return true;
+	} else if (msg->GetNumFloats() == count) {
+		for (int i = 0; i < count; i++) {
+			values[i] = (int) floor(msg->GetFloat(i) + 0.5f);
+		}
+		return true;
+	}
+	return false;
+}
+
+ControlServer::ControlServer(std::unordered_map<std::string, std::string> &parameters, const ControlSettings &settings) {
+	this->port = intParam(parameters, PARAM_CONTROL_PORT, DEFAULT_CONTROL_PORT);
+	this->pendingSettings = settings;
+	this->pendingCommand = COMMAND_NONE;
+	this->changed = false;
+	this->stopRequested = false;
+
+	// Build the address space
+	WOscContainer *root = new WOscContainer();
+	WOscContainer *container = new WOscContainer(root, OSC_CONTAINER);
+	new ControlMethod(container, this, METHOD_THRESHOLD, "threshold", "Set the threshold value (int), disabling automatic adaption");
+	new ControlMethod(container, this, METHOD_AUTO_THRESHOLD, "autothresh", "Adapt the threshold automatically (0 or 1)");
+	new ControlMethod(container, this, METHOD_ROTATE, "rotate", "Rotate the image by 180 degrees (0 or 1)");
+	new ControlMethod(container, this, METHOD_ARENA_RADIUS, "arenarad", "Set the radius of the arena circle (int)");
+	new ControlMethod(container, this, METHOD_TRACK_RECT_SIZE, "trackrectsize", "Set the size of tracking rectangles (int)");
+	new ControlMethod(container, this, METHOD_PRINT, "print", "Print tracking information (0 or 1)");
+	new ControlMethod(container, this, METHOD_ROI, "roi", "Set the region of interest (x, y, width, height), no arguments for the whole frame");
+	new ControlMethod(container, this, METHOD_RECORD, "record", "Start (1) or stop (0) recording");
+	new ControlMethod(container, this, METHOD_QUIT, "quit", "Quit the application");
+	new ControlMethod(container, this, METHOD_STATUS, "status", "Reply with the current settings");
+	new ControlMethod(container, this, METHOD_DIAGNOSTICS, "diagnostics",
+		"Reply with the segmentation and recognition counters (ints) and phase times in ms (floats) of the last frame");
+	SetAddressSpace(root);
+
+	this->sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (this->sock < 0) {
+		std::cerr << "Socket cannot be opened (error " << errno << ")\n";
+		throw 1;
+	}
+	struct sockaddr_in localaddr;
+	memset(&localaddr, 0, sizeof(localaddr));
+	localaddr.sin_family = AF_INET;
+	localaddr.sin_addr.s_addr = htonl(INADDR_ANY);
+	localaddr.sin_port = htons(this->port);
+	if (bind(this->sock, (struct sockaddr *) &localaddr, sizeof(localaddr)) != 0) {
+		std::cerr << "Control port " << this->port << " cannot be bound (error " << errno << ")\n";
+		throw 1;
+	}
+
+	if (!start()) {
+		throw 1;
+	}
+	std::cout << "Listening for control messages on port " << this->port << "\n";
+}
+
+ControlServer::~ControlServer() {
+	{
+		MutexLock lock(mutex);
+		stopRequested = true;
+	}
+	join();
+	close(this->sock);
+	GetAddressSpace()->RemoveAll();
+}
+
+ControlCommand ControlServer::applyChanges(ControlSettings &settings) {
+	if (!mutex.tryLock()) {
+		return COMMAND_NONE;
+	}
+	ControlCommand command = pendingCommand;
+	if (changed) {
+		settings = pendingSettings;
+		changed = false;
+	} else {
+		pendingSettings = settings;
+	}
+	pendingCommand = COMMAND_NONE;
+	mutex.unlock();
+	return command;
+}
+
+void ControlServer::NetworkSend(const char *data, int dataLen, const WOscNetReturn *networkReturnAddress) {
+	const ControlReturnAddress *returnAddress = (const ControlReturnAddress *) networkReturnAddress;
+	sendto(this->sock, data, dataLen, 0, (const struct sockaddr *) &returnAddress->addr, sizeof(returnAddress->addr));
+}
+
+void ControlServer::run() {
+	char buffer[MAX_PACKET_SIZE];
+	while (true) {
+		{
+			MutexLock lock(mutex);
+			if (stopRequested) {
+				break;
+			}
+		}
+
+		fd_set readSet;
+		FD_ZERO(&readSet);
+		FD_SET(this->sock, &readSet);
+		struct timeval timeout;
+		timeout.tv_sec = 0;
+		timeout.tv_usec = RECEIVE_TIMEOUT * 1000;
+		if (select(this->sock + 1, &readSet, NULL, NULL, &timeout) <= 0) {
+			continue;
+		}
+
+		ControlReturnAddress *returnAddress = new ControlReturnAddress();
+		socklen_t addrLen = sizeof(returnAddress->addr);
+		int dataLen = recvfrom(this->sock, buffer, MAX_PACKET_SIZE, 0,
+			(struct sockaddr *) &returnAddress->addr, &addrLen);
+		if (dataLen > 0) {
+			// The return address is released by the receiver
+			NetworkReceive(buffer, dataLen, returnAddress);
+		} else {
+			delete returnAddress;
+		}
+	}
+}
+
+void ControlServer::HandleOffendingPackets(const char * const data, int dataLen, const WOscException &exception) {
+	std::cerr << "Invalid control message received\n";
+}
+
+void ControlServer::HandleNonmatchedMessages(const WOscMessage *msg, const WOscNetReturn *networkReturnAddress) {
+	std::cerr << "Unknown control message " << msg->GetOscAddress().GetBuffer() << "\n";
+}
+
+void ControlServer::handleMessage(int method, const WOscMessage *msg, const WOscNetReturn *networkReturnAddress) {
+	MutexLock lock(mutex);
+	int values[4];
+	switch (method) {
+	case METHOD_THRESHOLD:
+		if (getNumbers(msg, values, 1) && values[0] >= 0 && values[0] <= 255) {
+			pendingSettings.threshold = values[0];
+			pendingSettings.autoThreshold = false;
+			changed = true;
+		}
+		break;
+	case METHOD_AUTO_THRESHOLD:
+		if (getNumbers(msg, values, 1)) {
+			pendingSettings.autoThreshold = values[0] != 0;
+			changed = true;
+		}
+		break;
+	case METHOD_ROTATE:
+		if (getNumbers(msg, values, 1)) {
+			pendingSettings.rotate = values[0] != 0;
+			changed = true;
+		}
+		break;
+	case METHOD_ARENA_RADIUS:
+		if (getNumbers(msg, values, 1) && values[0] >= 0) {
+			pendingSettings.arenaRadius = values[0];
+			changed = true;
+		}
+		break;
+	case METHOD_TRACK_RECT_SIZE:
+		if (getNumbers(msg, values, 1) && values[0] >= 0) {
+			pendingSettings.trackRectSize = values[0];
+			changed = true;
+		}
+		break;
+	case METHOD_PRINT:
+		if (getNumbers(msg, values, 1)) {
+			pendingSettings.print = values[0] != 0;
+			changed = true;
+		}
+		break;
+	case METHOD_ROI:
+		if (getNumbers(msg, values, 4) && values[2] > 0 && values[3] > 0) {
+			pendingSettings.roi = cv::Rect(values[0], values[1], values[2], values[3]);
+			changed = true;
+		} else if (msg->GetNumInts() == 0 && msg->GetNumFloats() == 0) {
+			pendingSettings.roi = cv::Rect();
+			changed = true;
+		}
+		break;
+	case METHOD_RECORD:
+		if (getNumbers(msg, values, 1)) {
+			pendingCommand = values[0] != 0 ? COMMAND_START_RECORDING : COMMAND_STOP_RECORDING;
+		}
+		break;
+	case METHOD_QUIT:
+		pendingCommand = COMMAND_QUIT;
+		break;
+	case METHOD_STATUS:
+		{
+			WOscMessage reply(OSC_STATUS_PATH);
+			reply.Add(pendingSettings.threshold);
+			reply.Add(pendingSettings.autoThreshold ? 1 : 0);
+			reply.Add(pendingSettings.rotate ? 1 : 0);
+			reply.Add(pendingSettings.arenaRadius);
+			reply.Add(pendingSettings.trackRectSize);
+			reply.Add(pendingSettings.print ? 1 : 0);
+			reply.Add(pendingSettings.roi.x);
+			reply.Add(pendingSettings.roi.y);
+			reply.Add(pendingSettings.roi.width);
+			reply.Add(pendingSettings.roi.height);
+			reply.Add(pendingSettings.loadLevel);
+			NetworkSend(reply.GetBuffer(), reply.GetBufferLen(), networkReturnAddress);
+		}
+		break;
+	case METHOD_DIAGNOSTICS:
+		{
+			WOscMessage reply(OSC_DIAGNOSTICS_PATH);
+			for (int i = 0; i < COUNTER_COUNT; i++) {
+				reply.Add(pendingSettings.diagnostics.counters[i]);
+			}
+			for (int i = 0; i < PHASE_COUNT; i++) {
+				reply.Add((float) pendingSettings.diagnostics.times[i]);
+			}
+			NetworkSend(reply.GetBuffer(), reply.GetBufferLen(), networkReturnAddress);
+		}
+		break;
+	}
+}
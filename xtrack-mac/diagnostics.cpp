@@ -0,0 +1,90 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Counters of the segmentation and fiducial recognition, used to tune the tracking parameters
+
+#include <algorithm>
+#include "diagnostics.h"
+
+static const char *COUNTER_NAMES[COUNTER_COUNT] = {
+	"regions", "created regions", "merged regions", "folded regions",
+	"saturated regions", "fragmented regions",
+	"deferred regions", "candidates", "lost symbols", "invalid ids", "unexpected ids", "approximate ids",
+	"blobs"
+};
+
+static const char *PHASE_NAMES[PHASE_COUNT] = {
+	"threshold", "segmentation", "recognition"
+};
+
+void TrackingDiagnostics::clear() {
+	for (int i = 0; i < COUNTER_COUNT; i++) {
+		counters[i] = 0;
+	}
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		times[i] = 0.0;
+	}
+}
+
+void TrackingDiagnostics::add(const SegmenterStats &segmenterStats, const FidtrackerXStats &fidtrackerStats) {
+	counters[COUNTER_REGIONS] += segmenterStats.region_count;
+	counters[COUNTER_CREATED_REGIONS] += segmenterStats.created_region_count;
+	counters[COUNTER_MERGED_REGIONS] += segmenterStats.merged_region_count;
+	counters[COUNTER_FOLDED_REGIONS] += segmenterStats.folded_region_count;
+	counters[COUNTER_SATURATED_REGIONS] += fidtrackerStats.saturated_count;
+	counters[COUNTER_FRAGMENTED_REGIONS] += fidtrackerStats.fragmented_count;
+	counters[COUNTER_DEFERRED_REGIONS] += fidtrackerStats.deferred_count;
+	counters[COUNTER_CANDIDATES] += fidtrackerStats.candidate_count;
+	counters[COUNTER_LOST_SYMBOLS] += fidtrackerStats.lost_symbol_count;
+	counters[COUNTER_INVALID_IDS] += fidtrackerStats.invalid_id_count;
+	counters[COUNTER_UNEXPECTED_IDS] += fidtrackerStats.unexpected_id_count;
+}
+
+DiagnosticsSummary::DiagnosticsSummary() {
+	this->frames = 0;
+	for (int i = 0; i < COUNTER_COUNT; i++) {
+		totalCounters[i] = 0.0;
+		maxCounters[i] = 0;
+	}
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		totalTimes[i] = 0.0;
+		maxTimes[i] = 0.0;
+	}
+}
+
+void DiagnosticsSummary::add(const TrackingDiagnostics &diagnostics) {
+	frames++;
+	for (int i = 0; i < COUNTER_COUNT; i++) {
+		totalCounters[i] += diagnostics.counters[i];
+		maxCounters[i] = std::max(maxCounters[i], diagnostics.counters[i]);
+	}
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		totalTimes[i] += diagnostics.times[i];
+		maxTimes[i] = std::max(maxTimes[i], diagnostics.times[i]);
+	}
+}
+
+void DiagnosticsSummary::print() {
+	if (frames == 0) {
+		return;
+	}
+	std::cout << "Tracking diagnostics per frame\n";
+	std::streamsize oldPrecision = std::cout.precision(1);
+	std::cout << std::fixed;
+	for (int i = 0; i < COUNTER_COUNT; i++) {
+		std::cout << "  " << COUNTER_NAMES[i] << ": avg " << totalCounters[i] / frames
+			<< ", max " << maxCounters[i] << "\n";
+	}
+	std::cout.precision(3);
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		std::cout << "  " << PHASE_NAMES[i] << ": avg " << totalTimes[i] / frames
+			<< " ms, max " << maxTimes[i] << " ms\n";
+	}
+	std::cout.unsetf(std::ios::fixed);
+	std::cout.precision(oldPrecision);
+}
@@ -0,0 +1,64 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Counters of the segmentation and fiducial recognition, used to tune the tracking parameters
+
+#pragma once
+
+#include "stdafx.h"
+#include "fidtrackX.h"
+
+enum DiagnosticsCounter {
+	// Regions in use at the same time at most, created regions, regions merged into others and
+	// noise regions folded into their surrounding region
+	COUNTER_REGIONS, COUNTER_CREATED_REGIONS, COUNTER_MERGED_REGIONS, COUNTER_FOLDED_REGIONS,
+	// Regions with too many neighbours for the adjacency lists, and their former neighbours
+	COUNTER_SATURATED_REGIONS, COUNTER_FRAGMENTED_REGIONS,
+	// Fragmented regions traversed after the search for roots
+	COUNTER_DEFERRED_REGIONS,
+	// Fiducial candidates, those with a fuzzy node count and those with an unknown tree
+	COUNTER_CANDIDATES, COUNTER_LOST_SYMBOLS, COUNTER_INVALID_IDS,
+	// Candidates with a valid id that is not expected, see FiducialFinder::setExpectedIds
+	COUNTER_UNEXPECTED_IDS,
+	// Candidates without valid id that were assigned the id of the closest known tree
+	COUNTER_APPROXIMATE_IDS,
+	// Regions tracked as blobs
+	COUNTER_BLOBS,
+	COUNTER_COUNT
+};
+
+enum DiagnosticsPhase {
+	PHASE_THRESHOLD, PHASE_SEGMENTATION, PHASE_RECOGNITION, PHASE_COUNT
+};
+
+// The counters and phase times (in milliseconds) of one frame, summed over all searched images
+struct TrackingDiagnostics {
+	int counters[COUNTER_COUNT];
+	double times[PHASE_COUNT];
+
+	// Reset all counters and times to zero.
+	void clear();
+	// Add the statistics of libfidtrack for one searched image.
+	void add(const SegmenterStats &segmenterStats, const FidtrackerXStats &fidtrackerStats);
+};
+
+// Collects the diagnostics of all frames and prints their averages and maxima.
+class DiagnosticsSummary {
+public:
+	DiagnosticsSummary();
+
+	void add(const TrackingDiagnostics &diagnostics);
+	void print();
+
+private:
+	int frames;
+	double totalCounters[COUNTER_COUNT];
+	int maxCounters[COUNTER_COUNT];
+	double totalTimes[PHASE_COUNT];
+	double maxTimes[PHASE_COUNT];
+};
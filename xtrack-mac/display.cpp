@@ -92,3 +92,7 @@ void CameraDisplay::displayTrackedImage(InputArray input) {
 		frameSize.width, frameSize.height)));
 	imshow("input", displayMat);
 }
+
+void CameraDisplay::setTrackRectSize(int size) {
+	trackRectSize = size;
+}
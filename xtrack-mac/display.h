@@ -21,6 +21,8 @@ public:
 	void drawTrackingInfo(cv::Mat &frameMat, TrackedFiducial fiducials[]);
 	// Display the given frame in the input window.
 	void displayTrackedImage(cv::InputArray input);
+	// Change the size of rectangles drawn onto tracked figures.
+	void setTrackRectSize(int size);
 
 private:
 	int trackRectSize;
@@ -0,0 +1,58 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Reducing the processing quality when frames take longer than the frame time
+
+#pragma once
+
+#include "stdafx.h"
+#include "timing.h"
+
+// Each level includes the reductions of the lower levels.
+enum LoadLevel {
+	// Full quality
+	LOAD_NORMAL,
+	// The windows are updated only for some frames
+	LOAD_REDUCED_PREVIEW,
+	// The contrast window is not updated
+	LOAD_NO_CONTRAST_WINDOW,
+	// Fiducials are searched only around their previous positions
+	LOAD_WINDOW_TRACKING,
+	// The input image is downscaled before thresholding
+	LOAD_DOWNSCALED,
+	LOAD_LEVEL_COUNT
+};
+
+// Watches the processing time of each frame and selects the load level. The level is
+// raised when the average processing time exceeds the frame time, and lowered again when
+// the processing time stays well below the frame time.
+class LoadGovernor {
+public:
+	LoadGovernor(int frameTime);
+
+	// Update the load level from the stage times of the last frame. Returns true if the
+	// level has changed.
+	bool update(StageTimer &stageTimer);
+	// The current load level.
+	LoadLevel level();
+	// A description of the given load level.
+	static const char *levelName(LoadLevel level);
+
+private:
+	double frameTime;
+	double averageTime;
+	LoadLevel currentLevel;
+	int overloadFrames;
+	int underloadFrames;
+	// The number of frames with low load required before the level is lowered
+	int recoveryFrames;
+	// Has the level been lowered since it was last raised?
+	bool recovered;
+	// The number of frames since the level has been lowered
+	int framesSinceRecovery;
+};
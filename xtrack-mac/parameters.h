@@ -33,6 +33,135 @@
 #define DEFAULT_CAMERA 0
 #define PARAM_CAMERA "camera"
 
+// A video file to be used as input instead of the camera. Each frame of the file is passed
+// through the whole tracking pipeline, and the processing times are printed when the end of the
+// file is reached. Files recorded by Xtrack have already been cut and rotated, so the 'quadratic'
+// and 'rotate' parameters should usually be disabled when replaying them.
+// Recorded contrast images (files ending with '.rle') are passed directly to the fiducial
+// tracking, using the timestamps stored with each frame.
+#define DEFAULT_REPLAY_FILE ""
+#define PARAM_REPLAY_FILE "replay"
+
+// If activated, the replayed video file is processed as fast as possible. Otherwise the frames
+// are processed at the frame rate stored in the file. The timestamps of the tracking information
+// are always derived from the frame rate of the file.
+#define DEFAULT_REPLAY_FAST false
+#define PARAM_REPLAY_FAST "replayfast"
+
+// If activated, the processing quality is reduced step by step when processing a frame takes
+// longer than the frame time: first the windows are updated less often, then the contrast
+// window is not updated anymore, then fiducials are only searched around their previous
+// positions, and finally the input is downscaled. The quality is restored when the load drops.
+// Each change of the level is printed on the console.
+#define DEFAULT_GOVERNOR false
+#define PARAM_GOVERNOR "governor"
+
+// Downsampling factor (1, 2 or 4) of the image in which fiducial candidates are searched.
+// The fiducials are then located in full resolution windows around the candidates, which is
+// much faster for large frames. Use 1 to search the full resolution image directly.
+#define DEFAULT_PYRAMID 1
+#define PARAM_PYRAMID "pyramid"
+
+// If activated, the positions and angles of recognized fiducials are computed with sub-pixel
+// accuracy from the grayscale image instead of the contrast image. This allows a lower camera
+// resolution for the same accuracy. Not available when replaying contrast images.
+#define DEFAULT_SUBPIXEL false
+#define PARAM_SUBPIXEL "subpixel"
+
+// If activated, each contrast image is compared with the last searched one in tiles. Fiducials
+// are searched only in a window around the changed tiles, and those found before in unchanged
+// tiles are kept, so that static scenes need little processing. The whole image is still
+// searched regularly. Cannot be combined with a pyramid factor larger than 1.
+#define DEFAULT_INCREMENTAL false
+#define PARAM_INCREMENTAL "incremental"
+
+// The maximum number of fragmented regions per image that are traversed again after the search
+// for fiducial roots. This recovers fiducials whose root contains a region with too many
+// neighbours, e.g. a speckled spot, at the cost of more time on cluttered images. 0 disables it.
+#define DEFAULT_DEFERRED_REGIONS 0
+#define PARAM_DEFERRED_REGIONS "deferred"
+
+// Closed regions with a single neighbour whose bounding box covers at most this number of pixels
+// are treated as noise and folded into their surrounding region while segmenting. This must be
+// smaller than the leaves of the fiducials in the searched images. 0 disables it.
+#define DEFAULT_NOISE_GATE 0
+#define PARAM_NOISE_GATE "noisegate"
+
+// Removes salt-and-pepper noise from the contrast image before segmenting it: 'open' removes
+// white specks, 'close' fills black specks and 'openclose' does both. Lines of the fiducials
+// that are narrower than three pixels in the searched image are removed as well.
+#define DEFAULT_MORPHOLOGY "none"
+#define PARAM_MORPHOLOGY "morphology"
+
+// A file with the trees of custom fiducials, either as text with one tree per line like
+// libfidtrack/all.trees, or converted into the binary form with libfidtrack/tools/convert_tree_set,
+// which is mapped into memory instead of parsed. Empty for the default trees.
+#define DEFAULT_TREE_FILE ""
+#define PARAM_TREE_FILE "treefile"
+
+// The recognizer of the fiducials: fidtrackX for the tree fiducials of reacTIVision (default or
+// custom trees), fidtrack120 for the 120 fiducials of six symbols arranged in two rows.
+#define DEFAULT_ENGINE "fidtrackX"
+#define PARAM_ENGINE "engine"
+
+// The ids of the fiducials in the installation, e.g. '0,1,2,3' or '0-3'. Candidates with other
+// valid ids are skipped before their position is computed, and the search of a frame stops as
+// soon as all of these fiducials have been found. Empty for all ids.
+#define DEFAULT_EXPECTED_IDS ""
+#define PARAM_EXPECTED_IDS "expectedids"
+
+// The number of additional threads computing the positions of the fiducial candidates. This
+// pays off for scenes with many fiducials or candidates in cluttered backgrounds. The threads are
+// started once, after the processing thread has been configured. 0 computes them on the
+// processing thread.
+#define DEFAULT_FIDUCIAL_THREADS 0
+#define PARAM_FIDUCIAL_THREADS "fidthreads"
+
+// The processor core to which the first fiducial thread is pinned, the others are pinned to the
+// following cores. The value -1 means that the threads can run on any core.
+#define DEFAULT_FIDUCIAL_THREAD_CPU -1
+#define PARAM_FIDUCIAL_THREAD_CPU "fidthreadcpu"
+
+// The real-time scheduling priority of the fiducial threads. The processing loop waits for them,
+// so they should not run with a lower priority than the loop. The value -1 means the priority of
+// the processing loop (rtprio), 0 means normal scheduling.
+#define DEFAULT_FIDUCIAL_THREAD_PRIORITY -1
+#define PARAM_FIDUCIAL_THREAD_PRIORITY "fidthreadprio"
+
+// Candidates without valid id near a fiducial tracked in the previous frame, e.g. partly covered
+// by a hand, get the id of the closest known tree if its depth string differs in at most this
+// number of inserted, removed or changed nodes. 0 disables the approximate matching.
+#define DEFAULT_APPROXIMATE_DISTANCE 0
+#define PARAM_APPROXIMATE_DISTANCE "approxdistance"
+
+// The number of trees compared per frame at most by the approximate matching
+#define DEFAULT_APPROXIMATE_BUDGET 500
+#define PARAM_APPROXIMATE_BUDGET "approxbudget"
+
+// Track the regions of the blob colour as blobs, e.g. fingers or untagged objects. The blobs are
+// found in the segmentation of the fiducials whenever the whole frame is searched.
+#define DEFAULT_BLOBS false
+#define PARAM_BLOBS "blobs"
+
+// The bounding box of a blob is larger than the minimal size and smaller than the maximal size in
+// both directions, in pixels of the tracked frame.
+#define DEFAULT_BLOB_MIN_SIZE 4
+#define PARAM_BLOB_MIN_SIZE "blobminsize"
+#define DEFAULT_BLOB_MAX_SIZE 100
+#define PARAM_BLOB_MAX_SIZE "blobmaxsize"
+
+// The colour of the blobs in the contrast image, white or black
+#define DEFAULT_BLOB_COLOUR "white"
+#define PARAM_BLOB_COLOUR "blobcolour"
+
+// Blobs that moved at most this number of pixels between two frames keep their session id.
+#define DEFAULT_BLOB_DISTANCE 32
+#define PARAM_BLOB_DISTANCE "blobdistance"
+
+// The TUIO profile of the blobs, 2Dblb for blobs with size or 2Dcur for cursors
+#define DEFAULT_BLOB_PROFILE "2Dblb"
+#define PARAM_BLOB_PROFILE "blobprofile"
+
 // The time in milliseconds between two frames captured from the camera.
 // The frame rate can be computed from this as 'framerate = 1000 / frametime'.
 // The default frame time corresponds to a frame rate of 30 fps.
@@ -61,6 +190,14 @@
 #define DEFAULT_THRESHOLD 128
 #define PARAM_THRESHOLD "threshold"
 
+// If activated, the threshold is adapted automatically to the brightness of the input images,
+// starting with the value of the 'threshold' parameter. The threshold is derived from the
+// histogram of each frame and corrected when fiducials are seen whose ids are not recognized:
+// the range of corrections is tried once, and the one recognizing most ids is kept until the
+// recognition gets worse.
+#define DEFAULT_AUTO_THRESHOLD false
+#define PARAM_AUTO_THRESHOLD "autothresh"
+
 // The target address for UDP messages containing tracking information.
 // The messages are sent in the TUIO format, see http://tuio.org/
 #define DEFAULT_ADDRESS "127.0.0.1"
@@ -70,6 +207,23 @@
 #define DEFAULT_PORT 3333
 #define PARAM_PORT "port"
 
+// The rate (in Hertz) at which TUIO messages are sent. Between two frames, the fiducials
+// are moved according to their speeds, and such messages contain an additional "pred"
+// command listing the predicted session ids. Use 0 to send one message per frame.
+#define DEFAULT_TUIO_RATE 0
+#define PARAM_TUIO_RATE "tuiorate"
+
+// The local UDP port where OSC messages for changing parameters at runtime are received.
+// The value 0 disables the control port. The supported messages are:
+//   /xtrack/threshold <int> (disables automatic adaption), /xtrack/autothresh <0|1>,
+//   /xtrack/rotate <0|1>, /xtrack/arenarad <int>,
+//   /xtrack/trackrectsize <int>, /xtrack/print <0|1>,
+//   /xtrack/roi <x> <y> <width> <height> (no arguments for the whole frame),
+//   /xtrack/record <0|1>, /xtrack/quit,
+//   /xtrack/status (replies with the current settings and the load level to the sender)
+#define DEFAULT_CONTROL_PORT 0
+#define PARAM_CONTROL_PORT "ctrlport"
+
 // The size of rectangles drawn onto tracked figures in the input window.
 #define DEFAULT_TRACK_RECT_SIZE 40
 #define PARAM_TRACK_RECT_SIZE "trackrectsize"
@@ -100,12 +254,52 @@
 #define DEFAULT_RECORD_FPS_SCALE 0.6
 #define PARAM_RECORD_FPS_SCALE "recfpsscale"
 
+// If activated, the contrast images are recorded in addition to the video. They are stored
+// losslessly with run-length encoding, independent of the 'recordscale' and 'recfpsscale'
+// parameters, in a file with the same name as the video and the extension '.rle'.
+// Such files can be given to the 'replay' parameter to rerun the fiducial tracking exactly.
+#define DEFAULT_RECORD_CONTRAST false
+#define PARAM_RECORD_CONTRAST "recordcontr"
+
 // A circle with this radius is drawn in the contrast image window.
 // It can be used to calibrate the camera position according to a
 // given arena.
 #define DEFAULT_ARENA_RADIUS 100
 #define PARAM_ARENA_RADIUS "arenarad"
 
+// Pixels outside the arena are left black in the contrast image and skipped when thresholding.
+// Use 'circle' for the arena circle given by the arena radius, a list of polygon corners in frame
+// pixels 'x1,y1,x2,y2,...', or the name of an image file in which the arena is white. By default
+// the whole frame is processed.
+#define DEFAULT_ARENA_MASK ""
+#define PARAM_ARENA_MASK "arenamask"
+
+// The processor core to which the processing loop (capture, tracking and output) is pinned.
+// The value -1 means that the thread can run on any core.
+#define DEFAULT_TRACK_CPU -1
+#define PARAM_TRACK_CPU "trackcpu"
+
+// The processor core to which background threads (recording and control port) are pinned.
+// The value -1 means that these threads can run on any core.
+#define DEFAULT_AUX_CPU -1
+#define PARAM_AUX_CPU "auxcpu"
+
+// The real-time scheduling priority of the processing loop (SCHED_FIFO on Linux, 1 to 99).
+// The value 0 means normal scheduling. Real-time priorities usually require permissions,
+// e.g. an 'rtprio' entry in /etc/security/limits.conf.
+#define DEFAULT_RT_PRIORITY 0
+#define PARAM_RT_PRIORITY "rtprio"
+
+// If activated, the memory of the process is locked so that it cannot be swapped out, and the
+// tracking buffers are loaded into memory before processing starts.
+#define DEFAULT_MEM_LOCK false
+#define PARAM_MEM_LOCK "memlock"
+
+// If activated, the tracking buffers are backed by huge pages where the system supports it
+// (transparent huge pages on Linux). This reduces TLB misses with large frame sizes.
+#define DEFAULT_HUGE_PAGES false
+#define PARAM_HUGE_PAGES "hugepages"
+
 
 // Utility methods for accessing parameter values
 
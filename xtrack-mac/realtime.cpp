@@ -0,0 +1,86 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Real-time scheduling and memory locking with a platform dependent implementation.
+// All functions print what has actually been granted by the operating system.
+
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "realtime.h"
+
+void configureCurrentThread(const std::string &name, int core, int priority) {
+	if (core >= 0) {
+#ifdef __linux__
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(core, &cpus);
+		int result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+		if (result == 0) {
+			std::cout << name << " thread pinned to core " << core << "\n";
+		} else {
+			std::cerr << name << " thread cannot be pinned to core " << core << " (error " << result << ")\n";
+		}
+#else
+		std::cerr << name << " thread cannot be pinned: not supported on this system\n";
+#endif
+	}
+	if (priority > 0) {
+		struct sched_param param;
+		param.sched_priority = priority;
+		int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+		if (result == 0) {
+			int policy;
+			pthread_getschedparam(pthread_self(), &policy, &param);
+			std::cout << name << " thread runs with SCHED_FIFO priority " << param.sched_priority << "\n";
+		} else {
+			std::cerr << name << " thread cannot use SCHED_FIFO priority " << priority << " (error " << result
+				<< "), check the real-time limits of the user (ulimit -r)\n";
+		}
+	}
+}
+
+bool lockProcessMemory() {
+	if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+		std::cout << "Process memory locked\n";
+		return true;
+	}
+	std::cerr << "Process memory cannot be locked (error " << errno
+		<< "), check the locked memory limit of the user (ulimit -l)\n";
+	return false;
+}
+
+void prefaultBuffer(void *buffer, size_t size, bool hugePages, bool lock) {
+	std::cout << "Prefaulted " << (size >> 10) << " KB of tracking buffers";
+	if (hugePages) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+		// Only whole huge pages inside the buffer can be remapped; this must happen before the pages are touched
+		const size_t hugePageSize = 2 << 20;
+		size_t start = ((size_t) buffer + hugePageSize - 1) & ~(hugePageSize - 1);
+		size_t end = ((size_t) buffer + size) & ~(hugePageSize - 1);
+		if (end > start && madvise((void *) start, end - start, MADV_HUGEPAGE) == 0) {
+			std::cout << ", " << ((end - start) >> 20) << " MB with huge pages";
+		} else {
+			std::cout << ", huge pages not granted";
+		}
+#else
+		std::cout << ", huge pages are not supported";
+#endif
+	}
+	std::cout << "\n";
+
+	size_t pageSize = sysconf(_SC_PAGESIZE);
+	volatile unsigned char *bytes = (volatile unsigned char *) buffer;
+	for (size_t offset = 0; offset < size; offset += pageSize) {
+		// Buffers may already hold data, so each page is faulted in without changing it
+		bytes[offset] = bytes[offset];
+	}
+	// The whole process is locked with 'lockProcessMemory'
+}
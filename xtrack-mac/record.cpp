@@ -77,6 +77,11 @@ void CameraRecorder::stopRecording() {
 	std::cout << "Stopped recording.\n";
 }
 
+std::string CameraRecorder::getRecordingFileName(const std::string &extension) {
+	std::string fileName = getFileName(lastPlayedFileNum);
+	return fileName.substr(0, fileName.length() - FILE_EXT.length()) + extension;
+}
+
 bool CameraRecorder::startPlayback() {
 	int nextFileNum = lastPlayedFileNum;
 	if (lastPlayedFileNum < 0) {
@@ -27,6 +27,8 @@ public:
 	void recordFrame(cv::InputArray input);
 	// Stop recording.
 	void stopRecording();
+	// The name of the current or last recorded video file with the given extension.
+	std::string getRecordingFileName(const std::string &extension);
 	// Start playback of the last recorded or played video file.
 	bool startPlayback();
 	// Play back the next frame.
@@ -0,0 +1,120 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Threading primitives with a platform dependent implementation
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/time.h>
+#include "threads.h"
+
+Mutex::Mutex() {
+	pthread_mutex_t *mutex = new pthread_mutex_t;
+	pthread_mutex_init(mutex, NULL);
+	this->handle = mutex;
+}
+
+Mutex::~Mutex() {
+	pthread_mutex_t *mutex = (pthread_mutex_t *) handle;
+	pthread_mutex_destroy(mutex);
+	delete mutex;
+}
+
+void Mutex::lock() {
+	pthread_mutex_lock((pthread_mutex_t *) handle);
+}
+
+bool Mutex::tryLock() {
+	return pthread_mutex_trylock((pthread_mutex_t *) handle) == 0;
+}
+
+void Mutex::unlock() {
+	pthread_mutex_unlock((pthread_mutex_t *) handle);
+}
+
+Condition::Condition() {
+	pthread_cond_t *condition = new pthread_cond_t;
+	pthread_cond_init(condition, NULL);
+	this->handle = condition;
+}
+
+Condition::~Condition() {
+	pthread_cond_t *condition = (pthread_cond_t *) handle;
+	pthread_cond_destroy(condition);
+	delete condition;
+}
+
+void Condition::wait(Mutex &mutex, int timeout) {
+	if (timeout < 0) {
+		pthread_cond_wait((pthread_cond_t *) handle, (pthread_mutex_t *) mutex.handle);
+	} else {
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		long nsec = now.tv_usec * 1000L + (timeout % 1000) * 1000000L;
+		struct timespec until;
+		until.tv_sec = now.tv_sec + timeout / 1000 + nsec / 1000000000L;
+		until.tv_nsec = nsec % 1000000000L;
+		pthread_cond_timedwait((pthread_cond_t *) handle, (pthread_mutex_t *) mutex.handle, &until);
+	}
+}
+
+void Condition::notifyAll() {
+	pthread_cond_broadcast((pthread_cond_t *) handle);
+}
+
+struct ThreadEntry {
+	static void *execute(void *thread) {
+#ifdef __linux__
+		if (Thread::defaultCore >= 0) {
+			cpu_set_t cpus;
+			CPU_ZERO(&cpus);
+			CPU_SET(Thread::defaultCore, &cpus);
+			pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+		}
+#endif
+		((Thread *) thread)->run();
+		return NULL;
+	}
+};
+
+int Thread::defaultCore = -1;
+
+Thread::Thread() {
+	this->handle = NULL;
+}
+
+Thread::~Thread() {
+	join();
+}
+
+bool Thread::start() {
+	if (handle != NULL) {
+		return false;
+	}
+	pthread_t *thread = new pthread_t;
+	if (pthread_create(thread, NULL, ThreadEntry::execute, this) != 0) {
+		std::cerr << "Thread cannot be started\n";
+		delete thread;
+		return false;
+	}
+	handle = thread;
+	return true;
+}
+
+void Thread::join() {
+	if (handle != NULL) {
+		pthread_t *thread = (pthread_t *) handle;
+		pthread_join(*thread, NULL);
+		delete thread;
+		handle = NULL;
+	}
+}
+
+void Thread::setDefaultCore(int core) {
+	defaultCore = core;
+}
@@ -0,0 +1,83 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Threading primitives with a platform dependent implementation
+
+#pragma once
+
+#include "stdafx.h"
+
+class Mutex {
+public:
+	Mutex();
+	~Mutex();
+
+	// Acquire the lock, waiting until it is released by other threads.
+	void lock();
+	// Acquire the lock only if no other thread holds it. Returns true if the lock was acquired.
+	bool tryLock();
+	// Release the lock.
+	void unlock();
+
+private:
+	friend class Condition;
+	void *handle;
+};
+
+// Holds a lock on the given mutex until it goes out of scope.
+class MutexLock {
+public:
+	MutexLock(Mutex &mutex) : mutex(mutex) {
+		mutex.lock();
+	}
+	~MutexLock() {
+		mutex.unlock();
+	}
+
+private:
+	Mutex &mutex;
+};
+
+class Condition {
+public:
+	Condition();
+	~Condition();
+
+	// Release the mutex, which must be locked by the calling thread, and wait until the condition
+	// is notified or the timeout in milliseconds has elapsed. A negative timeout means to wait
+	// without limit. The mutex is locked again before returning.
+	void wait(Mutex &mutex, int timeout = -1);
+	// Wake up all threads waiting for this condition.
+	void notifyAll();
+
+private:
+	void *handle;
+};
+
+// Base class for threads: subclasses implement the 'run' method.
+class Thread {
+public:
+	Thread();
+	virtual ~Thread();
+
+	// Start a new thread executing the 'run' method.
+	bool start();
+	// Wait until the thread has finished.
+	void join();
+	// Pin all threads started afterwards to the given processor core. A negative value
+	// means no restriction.
+	static void setDefaultCore(int core);
+
+protected:
+	virtual void run() = 0;
+
+private:
+	friend struct ThreadEntry;
+	void *handle;
+	static int defaultCore;
+};
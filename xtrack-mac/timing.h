@@ -0,0 +1,42 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Measuring the processing time of the individual pipeline stages
+
+#pragma once
+
+#include "stdafx.h"
+
+enum ProcessingStage {
+	STAGE_CAPTURE, STAGE_PREPROCESS, STAGE_TRACKING, STAGE_OUTPUT, STAGE_DISPLAY, STAGE_COUNT
+};
+
+class StageTimer {
+public:
+	StageTimer();
+
+	// Mark the start of a new frame.
+	void startFrame();
+	// Mark the end of the given stage. The time since the previous mark is added to that stage.
+	void endStage(ProcessingStage stage);
+	// The time in milliseconds spent in the given stage while processing the last frame.
+	double lastTime(ProcessingStage stage);
+	// The number of frames processed so far.
+	int frameCount();
+	// Print the average and maximum stage times and the overall throughput.
+	void printSummary();
+
+private:
+	double tickPeriod;
+	int64 firstTick;
+	int64 lastTick;
+	int frames;
+	double lastTimes[STAGE_COUNT];
+	double totalTimes[STAGE_COUNT];
+	double maxTimes[STAGE_COUNT];
+};
@@ -17,6 +17,13 @@ TuioServer::TuioServer(std::unordered_map<std::string, std::string> &parameters)
 	this->ipaddr = stringParam(parameters, PARAM_ADDRESS, DEFAULT_ADDRESS);
 	this->port = intParam(parameters, PARAM_PORT, DEFAULT_PORT);
 	this->fseq = 0;
+	std::string blobProfile = stringParam(parameters, PARAM_BLOB_PROFILE, DEFAULT_BLOB_PROFILE);
+	if (blobProfile != "2Dblb" && blobProfile != "2Dcur") {
+		std::cerr << "Invalid blob profile " << blobProfile << ", use 2Dblb or 2Dcur\n";
+		throw 1;
+	}
+	this->blobPath = "/tuio/" + blobProfile;
+	this->blobSeq = 0;
 
 	// TODO implement
 //	WSADATA wsaData;
@@ -41,7 +48,7 @@ TuioServer::~TuioServer() {
 //	WSACleanup();
 }
 
-void TuioServer::sendMessage(TrackedFiducial fiducials[]) {
+void TuioServer::sendMessage(TrackedFiducial fiducials[], bool predicted) {
 	WOscBundle bundle;
 
 	// Alive message
@@ -75,13 +82,77 @@ void TuioServer::sendMessage(TrackedFiducial fiducials[]) {
 		}
 	}
 
+	// Prediction message, not part of the TUIO specification and ignored by other clients
+	if (predicted) {
+		WOscMessage *predMsg = new WOscMessage(OSC_PATH);
+		predMsg->Add("pred");
+		for (int i = 0; i < MAX_FIDUCIALS; i++) {
+			if (fiducials[i].isTracked) {
+				predMsg->Add(i);
+			}
+		}
+		bundle.Add(predMsg);
+	}
+
 	// Frame sequence message
 	WOscMessage *seqMsg = new WOscMessage(OSC_PATH);
 	seqMsg->Add("fseq");
 	seqMsg->Add(this->fseq++);
 	bundle.Add(seqMsg);
 
-	// Send the bundle via UDP
+	sendBundle(bundle);
+}
+
+void TuioServer::sendBlobs(const std::vector<TrackedBlob> &blobs) {
+	WOscBundle bundle;
+	const char *path = this->blobPath.c_str();
+	bool cursors = this->blobPath == "/tuio/2Dcur";
+
+	// Alive message
+	WOscMessage *aliveMsg = new WOscMessage(path);
+	aliveMsg->Add("alive");
+	for (size_t i = 0; i < blobs.size(); i++) {
+		aliveMsg->Add(blobs[i].sessionId);
+	}
+	bundle.Add(aliveMsg);
+
+	// Set message, blobs are not rotated
+	for (size_t i = 0; i < blobs.size(); i++) {
+		const TrackedBlob &blob = blobs[i];
+		WOscMessage *setMsg = new WOscMessage(path);
+		setMsg->Add("set");
+		setMsg->Add(blob.sessionId); // session id
+		setMsg->Add(blob.x); // horizontal position
+		setMsg->Add(blob.y); // vertical position
+		if (cursors) {
+			setMsg->Add(blob.xspeed); // horizontal motion speed
+			setMsg->Add(blob.yspeed); // vertical motion speed
+			setMsg->Add(blob.xyacc); // motion acceleration
+		} else {
+			setMsg->Add(0.0f); // angle
+			setMsg->Add(blob.width); // width
+			setMsg->Add(blob.height); // height
+			setMsg->Add(blob.area); // area
+			setMsg->Add(blob.xspeed); // horizontal motion speed
+			setMsg->Add(blob.yspeed); // vertical motion speed
+			setMsg->Add(0.0f); // rotation speed
+			setMsg->Add(blob.xyacc); // motion acceleration
+			setMsg->Add(0.0f); // rotation acceleration
+		}
+		bundle.Add(setMsg);
+	}
+
+	// Frame sequence message
+	WOscMessage *seqMsg = new WOscMessage(path);
+	seqMsg->Add("fseq");
+	seqMsg->Add(this->blobSeq++);
+	bundle.Add(seqMsg);
+
+	sendBundle(bundle);
+}
+
+// Send the bundle via UDP
+void TuioServer::sendBundle(WOscBundle &bundle) {
 	// TODO implement
 //	struct sockaddr_in servaddr;
 //	servaddr.sin_family = AF_INET;
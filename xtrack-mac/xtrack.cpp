@@ -14,11 +14,22 @@
 
 #include "stdafx.h"
 #include "fiducials.h"
+#include "threshold.h"
 #include "tuio.h"
 #include "display.h"
 #include "record.h"
+#include "rlerecord.h"
+#include "timing.h"
+#include "control.h"
+#include "autothreshold.h"
+#include "realtime.h"
+#include "governor.h"
+#include "upsampling.h"
+#include "arena.h"
 
 const double CLOCK_FACTOR = CLOCKS_PER_SEC / 1000.0;
+// Under high load, the windows are updated only every PREVIEW_DIVIDER frames
+const int PREVIEW_DIVIDER = 3;
 
 static bool term_requested = false;
 
@@ -107,121 +118,371 @@ void displayContrastImage(InputArray input, RecordMode recordMode, int arenaRadi
 
 // Process the camera stream until the application is quit.
 void process(std::unordered_map<std::string, std::string> &parameters) {
-	// Create the camera capture
-	VideoCapture capture(intParam(parameters, PARAM_CAMERA, DEFAULT_CAMERA));
-	if (!capture.isOpened()) {
-        std::cerr << "Camera cannot be opened\n";
-		throw 1;
+	// Create the camera capture, or open a video file if one is given for replay
+	std::string replayFile = stringParam(parameters, PARAM_REPLAY_FILE, DEFAULT_REPLAY_FILE);
+	bool replay = !replayFile.empty();
+	bool replayContrast = replay && isRleFileName(replayFile);
+	VideoCapture capture;
+	ThresholdPlayer thresholdPlayer;
+	Size frameSize;
+	if (replayContrast) {
+		if (!thresholdPlayer.open(replayFile)) {
+			std::cerr << "Contrast image file " << replayFile << " cannot be opened\n";
+			throw 1;
+		}
+		frameSize = thresholdPlayer.frameSize();
+	} else if (replay) {
+		capture.open(replayFile);
+		if (!capture.isOpened()) {
+			std::cerr << "Video file " << replayFile << " cannot be opened\n";
+			throw 1;
+		}
+		frameSize = Size((int) capture.get(CV_CAP_PROP_FRAME_WIDTH),
+				(int) capture.get(CV_CAP_PROP_FRAME_HEIGHT));
+	} else {
+		capture.open(intParam(parameters, PARAM_CAMERA, DEFAULT_CAMERA));
+		if (!capture.isOpened()) {
+			std::cerr << "Camera cannot be opened\n";
+			throw 1;
+		}
+		frameSize = Size(intParam(parameters, PARAM_FRAME_WIDTH, DEFAULT_FRAME_WIDTH),
+				intParam(parameters, PARAM_FRAME_HEIGHT, DEFAULT_FRAME_HEIGHT));
+		capture.set(CV_CAP_PROP_FRAME_WIDTH, frameSize.width);
+		capture.set(CV_CAP_PROP_FRAME_HEIGHT, frameSize.height);
 	}
-	Size frameSize(intParam(parameters, PARAM_FRAME_WIDTH, DEFAULT_FRAME_WIDTH),
-			intParam(parameters, PARAM_FRAME_HEIGHT, DEFAULT_FRAME_HEIGHT));
-	capture.set(CV_CAP_PROP_FRAME_WIDTH, frameSize.width);
-	capture.set(CV_CAP_PROP_FRAME_HEIGHT, frameSize.height);
 
 	// Read command line parameters
 	int frameTime = intParam(parameters, PARAM_FRAME_TIME, DEFAULT_FRAME_TIME);
-	int thresholdVal = intParam(parameters, PARAM_THRESHOLD, DEFAULT_THRESHOLD);
-	bool rotateImage = boolParam(parameters, PARAM_ROTATE, DEFAULT_ROTATE);
+	bool replayFast = boolParam(parameters, PARAM_REPLAY_FAST, DEFAULT_REPLAY_FAST);
 	bool makeQuadratic = boolParam(parameters, PARAM_QUADRATIC, DEFAULT_QUADRATIC);
 	bool showInputWindow = boolParam(parameters, PARAM_SHOW_INPUT, DEFAULT_SHOW_INPUT);
 	bool showContrastWindow = boolParam(parameters, PARAM_SHOW_CONTRAST, DEFAULT_SHOW_CONTRAST);
-	bool printData = boolParam(parameters, PARAM_PRINT, DEFAULT_PRINT);
-	int arenaRadius = intParam(parameters, PARAM_ARENA_RADIUS, DEFAULT_ARENA_RADIUS);
+	bool recordContrast = boolParam(parameters, PARAM_RECORD_CONTRAST, DEFAULT_RECORD_CONTRAST);
+	int controlPort = intParam(parameters, PARAM_CONTROL_PORT, DEFAULT_CONTROL_PORT);
+	int trackCpu = intParam(parameters, PARAM_TRACK_CPU, DEFAULT_TRACK_CPU);
+	int rtPriority = intParam(parameters, PARAM_RT_PRIORITY, DEFAULT_RT_PRIORITY);
+	bool memLock = boolParam(parameters, PARAM_MEM_LOCK, DEFAULT_MEM_LOCK);
+	bool hugePages = boolParam(parameters, PARAM_HUGE_PAGES, DEFAULT_HUGE_PAGES);
+	bool useGovernor = boolParam(parameters, PARAM_GOVERNOR, DEFAULT_GOVERNOR);
+	int pyramidFactor = intParam(parameters, PARAM_PYRAMID, DEFAULT_PYRAMID);
+	bool subpixel = boolParam(parameters, PARAM_SUBPIXEL, DEFAULT_SUBPIXEL);
+	bool incremental = boolParam(parameters, PARAM_INCREMENTAL, DEFAULT_INCREMENTAL);
+	int deferredRegions = intParam(parameters, PARAM_DEFERRED_REGIONS, DEFAULT_DEFERRED_REGIONS);
+	int noiseGate = intParam(parameters, PARAM_NOISE_GATE, DEFAULT_NOISE_GATE);
+	int tuioRate = intParam(parameters, PARAM_TUIO_RATE, DEFAULT_TUIO_RATE);
+	if (pyramidFactor != 1 && pyramidFactor != 2 && pyramidFactor != 4) {
+		std::cerr << "Invalid pyramid factor " << pyramidFactor << ", use 1, 2 or 4\n";
+		throw 1;
+	}
+	// Pyramid detection always searches the whole coarse image
+	if (pyramidFactor != 1 && incremental) {
+		std::cerr << "Incremental search cannot be combined with pyramid factor " << pyramidFactor << "\n";
+		throw 1;
+	}
+	std::string morphology = stringParam(parameters, PARAM_MORPHOLOGY, DEFAULT_MORPHOLOGY);
+	int morphologyFilter;
+	if (morphology == "none") {
+		morphologyFilter = 0;
+	} else if (morphology == "open") {
+		morphologyFilter = PACKED_OPEN_FILTER;
+	} else if (morphology == "close") {
+		morphologyFilter = PACKED_CLOSE_FILTER;
+	} else if (morphology == "openclose") {
+		morphologyFilter = PACKED_OPEN_FILTER | PACKED_CLOSE_FILTER;
+	} else {
+		std::cerr << "Invalid morphology " << morphology << ", use none, open, close or openclose\n";
+		throw 1;
+	}
+	std::string engineName = stringParam(parameters, PARAM_ENGINE, DEFAULT_ENGINE);
+	FiducialEngine engine;
+	if (engineName == "fidtrackX") {
+		engine = ENGINE_FIDTRACKX;
+	} else if (engineName == "fidtrack120") {
+		engine = ENGINE_FIDTRACK120;
+	} else {
+		std::cerr << "Invalid engine " << engineName << ", use fidtrackX or fidtrack120\n";
+		throw 1;
+	}
+	bool blobs = boolParam(parameters, PARAM_BLOBS, DEFAULT_BLOBS);
+	std::string blobColour = stringParam(parameters, PARAM_BLOB_COLOUR, DEFAULT_BLOB_COLOUR);
+	if (blobColour != "white" && blobColour != "black") {
+		std::cerr << "Invalid blob colour " << blobColour << ", use white or black\n";
+		throw 1;
+	}
+
+	// These parameters can be changed at runtime through the control port
+	ControlSettings settings;
+	settings.threshold = intParam(parameters, PARAM_THRESHOLD, DEFAULT_THRESHOLD);
+	settings.autoThreshold = boolParam(parameters, PARAM_AUTO_THRESHOLD, DEFAULT_AUTO_THRESHOLD);
+	settings.rotate = boolParam(parameters, PARAM_ROTATE, DEFAULT_ROTATE);
+	settings.arenaRadius = intParam(parameters, PARAM_ARENA_RADIUS, DEFAULT_ARENA_RADIUS);
+	settings.trackRectSize = intParam(parameters, PARAM_TRACK_RECT_SIZE, DEFAULT_TRACK_RECT_SIZE);
+	settings.print = boolParam(parameters, PARAM_PRINT, DEFAULT_PRINT);
+	settings.loadLevel = LOAD_NORMAL;
+	settings.diagnostics.clear();
 	
 	// Initialize processing data
 	if (showContrastWindow) {
 		namedWindow("contrast", CV_WINDOW_AUTOSIZE | CV_WINDOW_KEEPRATIO | CV_GUI_EXPANDED);
 	}
-	Size trackedFrameSize(makeQuadratic ? frameSize.height : frameSize.width,
+	// Recorded contrast images have already been cut
+	Size trackedFrameSize(makeQuadratic && !replayContrast ? frameSize.height : frameSize.width,
 			frameSize.height);
 	CameraDisplay *cameraDisplay = NULL;
 	if (showInputWindow) {
 		cameraDisplay = new CameraDisplay(parameters, frameSize);
 	}
-	FiducialFinder fiducialFinder(trackedFrameSize);
+	FiducialFinder fiducialFinder(trackedFrameSize, stringParam(parameters, PARAM_TREE_FILE, DEFAULT_TREE_FILE));
+	ArenaMask arenaMask(stringParam(parameters, PARAM_ARENA_MASK, DEFAULT_ARENA_MASK), trackedFrameSize);
+	fiducialFinder.setPyramidFactor(pyramidFactor);
+	fiducialFinder.setIncremental(incremental);
+	fiducialFinder.setDeferredRegions(deferredRegions);
+	fiducialFinder.setNoiseGate(noiseGate);
+	fiducialFinder.setMorphology(morphologyFilter);
+	fiducialFinder.setEngine(engine);
+	fiducialFinder.setExpectedIds(stringParam(parameters, PARAM_EXPECTED_IDS, DEFAULT_EXPECTED_IDS));
+	fiducialFinder.setApproximateMatching(intParam(parameters, PARAM_APPROXIMATE_DISTANCE, DEFAULT_APPROXIMATE_DISTANCE),
+		intParam(parameters, PARAM_APPROXIMATE_BUDGET, DEFAULT_APPROXIMATE_BUDGET));
+	fiducialFinder.setBlobTracking(blobs, intParam(parameters, PARAM_BLOB_MIN_SIZE, DEFAULT_BLOB_MIN_SIZE),
+		intParam(parameters, PARAM_BLOB_MAX_SIZE, DEFAULT_BLOB_MAX_SIZE), blobColour == "white" ? 255 : 0,
+		intParam(parameters, PARAM_BLOB_DISTANCE, DEFAULT_BLOB_DISTANCE));
 	TuioServer tuioServer(parameters);
 	CameraRecorder cameraRecorder(parameters, trackedFrameSize);
+	ThresholdRecorder thresholdRecorder;
 	RecordMode recordMode = NORMAL;
+	StageTimer stageTimer;
+	DiagnosticsSummary diagnosticsSummary;
+	ThresholdController thresholdController;
+
+	// Avoid scheduling delays and page faults while processing frames
+	configureCurrentThread("Processing", trackCpu, rtPriority);
+	// The processing thread waits for the fiducial threads, so they are configured like it rather
+	// than pinned to the core of the background threads
+	int workerPriority = intParam(parameters, PARAM_FIDUCIAL_THREAD_PRIORITY, DEFAULT_FIDUCIAL_THREAD_PRIORITY);
+	fiducialFinder.setWorkerThreads(intParam(parameters, PARAM_FIDUCIAL_THREADS, DEFAULT_FIDUCIAL_THREADS),
+		intParam(parameters, PARAM_FIDUCIAL_THREAD_CPU, DEFAULT_FIDUCIAL_THREAD_CPU),
+		workerPriority < 0 ? rtPriority : workerPriority);
+	Thread::setDefaultCore(intParam(parameters, PARAM_AUX_CPU, DEFAULT_AUX_CPU));
+	if (memLock || hugePages) {
+		fiducialFinder.prefaultBuffers(hugePages, memLock);
+	}
+	if (memLock) {
+		lockProcessMemory();
+	}
 
-	Mat flipMat, grayScaleMat, thresholdMat, displayMat;
-
-	do {
-		double frameStartClock = clock() * CLOCK_FACTOR;
+	ControlServer *controlServer = NULL;
+	if (controlPort > 0) {
+		controlServer = new ControlServer(parameters, settings);
+	}
+	TuioUpsampler *tuioUpsampler = NULL;
+	if (tuioRate > 0) {
+		tuioUpsampler = new TuioUpsampler(tuioServer, tuioRate);
+	}
 
-		// Capture a frame
-		Mat frameMat;
-		capture >> frameMat;
-		if (frameMat.cols == 0 || frameMat.rows == 0) {
-			std::cout << "No image from camera.\n";
-			break;
+	// Replayed frames are timestamped and paced according to the frame rate of the file
+	double replayFrameTime = frameTime;
+	if (replay && !replayContrast) {
+		double replayFrameRate = capture.get(CV_CAP_PROP_FPS);
+		if (replayFrameRate > 0) {
+			replayFrameTime = 1000.0 / replayFrameRate;
+			frameTime = (int) (replayFrameTime + 0.5);
 		}
+	}
 
-		// Cut the frame to make it quadratic
-		Mat quadrMat(frameMat, makeQuadratic
-			? Rect((frameMat.cols - frameMat.rows) / 2, 0, frameMat.rows, frameMat.rows)
-			: Rect(0, 0, frameMat.cols, frameMat.rows));
+	LoadGovernor loadGovernor(frameTime);
 
-		// Rotate the frame by 180 degrees
-		if (rotateImage) {
-			flip(quadrMat, flipMat, -1);
-		} else {
-			flipMat = quadrMat;
+	Mat flipMat, grayScaleMat, scaledMat, thresholdMat, displayMat;
+
+	do {
+		double frameStartClock = clock() * CLOCK_FACTOR;
+		stageTimer.startFrame();
+
+		// Apply the parameter changes received since the last frame
+		ControlCommand command = COMMAND_NONE;
+		if (controlServer != NULL) {
+			command = controlServer->applyChanges(settings);
+			if (cameraDisplay != NULL) {
+				cameraDisplay->setTrackRectSize(settings.trackRectSize);
+			}
 		}
 
-		// Convert to grayscale
-		if (flipMat.channels() == 3) {
-			cvtColor(flipMat, grayScaleMat, CV_BGR2GRAY);
+		// Reduce the processing quality according to the load
+		LoadLevel loadLevel = loadGovernor.level();
+		settings.loadLevel = loadLevel;
+		bool updateWindows = loadLevel < LOAD_REDUCED_PREVIEW || stageTimer.frameCount() % PREVIEW_DIVIDER == 0;
+		int downscale = loadLevel >= LOAD_DOWNSCALED ? 2 : 1;
+		fiducialFinder.setWindowTracking(loadLevel >= LOAD_WINDOW_TRACKING);
+
+		double frameTimestamp;
+		if (replayContrast) {
+			// Read a recorded contrast image, which replaces capturing and preprocessing
+			if (!thresholdPlayer.readFrame(thresholdMat, frameTimestamp)) {
+				std::cout << "End of replayed contrast image file.\n";
+				break;
+			}
+			stageTimer.endStage(STAGE_CAPTURE);
+			if (arenaMask.isEnabled()) {
+				arenaMask.update(thresholdMat.size(), settings.arenaRadius);
+				arenaMask.clear(thresholdMat);
+			}
+			cvtColor(thresholdMat, flipMat, CV_GRAY2BGR);
+			stageTimer.endStage(STAGE_PREPROCESS);
 		} else {
-			grayScaleMat = flipMat;
-		}
+			// Capture a frame
+			Mat frameMat;
+			capture >> frameMat;
+			if (frameMat.cols == 0 || frameMat.rows == 0) {
+				if (replay) {
+					std::cout << "End of replayed video file.\n";
+				} else {
+					std::cout << "No image from camera.\n";
+				}
+				break;
+			}
+			frameTimestamp = replay
+				? (stageTimer.frameCount() - 1) * replayFrameTime
+				: frameStartClock;
+			stageTimer.endStage(STAGE_CAPTURE);
+
+			// Cut the frame to make it quadratic
+			Mat quadrMat(frameMat, makeQuadratic
+				? Rect((frameMat.cols - frameMat.rows) / 2, 0, frameMat.rows, frameMat.rows)
+				: Rect(0, 0, frameMat.cols, frameMat.rows));
+
+			// Rotate the frame by 180 degrees
+			if (settings.rotate) {
+				flip(quadrMat, flipMat, -1);
+			} else {
+				flipMat = quadrMat;
+			}
+
+			// Convert to grayscale
+			if (flipMat.channels() == 3) {
+				cvtColor(flipMat, grayScaleMat, CV_BGR2GRAY);
+			} else {
+				grayScaleMat = flipMat;
+			}
+			if (downscale > 1) {
+				resize(grayScaleMat, scaledMat, Size(grayScaleMat.cols / downscale, grayScaleMat.rows / downscale),
+					0, 0, INTER_AREA);
+				grayScaleMat = scaledMat;
+			}
+
+			// Adapt the threshold to the brightness of the region of interest
+			Rect roi = Rect(settings.roi.x / downscale, settings.roi.y / downscale,
+				settings.roi.width / downscale, settings.roi.height / downscale)
+				& Rect(0, 0, grayScaleMat.cols, grayScaleMat.rows);
+			bool useRoi = roi.area() > 0 && roi.size() != grayScaleMat.size();
+			if (settings.autoThreshold) {
+				settings.threshold = thresholdController.computeThreshold(
+					useRoi ? Mat(grayScaleMat, roi) : grayScaleMat, settings.threshold);
+			}
 
-		// Apply a threshold
-		threshold(grayScaleMat, thresholdMat, thresholdVal, 255, THRESH_BINARY);
+			// Apply a threshold, leaving everything outside the arena and the region of interest black
+			if (arenaMask.isEnabled()) {
+				arenaMask.update(grayScaleMat.size(), settings.arenaRadius);
+				arenaMask.threshold(grayScaleMat, thresholdMat, settings.threshold,
+					useRoi ? roi : Rect(0, 0, grayScaleMat.cols, grayScaleMat.rows));
+			} else if (useRoi) {
+				thresholdMat.create(grayScaleMat.size(), CV_8UC1);
+				thresholdMat.setTo(Scalar(0));
+				Mat roiMat(thresholdMat, roi);
+				threshold(Mat(grayScaleMat, roi), roiMat, settings.threshold, 255, THRESH_BINARY);
+			} else {
+				threshold(grayScaleMat, thresholdMat, settings.threshold, 255, THRESH_BINARY);
+			}
+			stageTimer.endStage(STAGE_PREPROCESS);
+		}
 
 		// Find fiducials
-		fiducialFinder.findFiducials(thresholdMat, frameStartClock);
+		fiducialFinder.findFiducials(thresholdMat, frameTimestamp,
+			subpixel && !replayContrast ? grayScaleMat : Mat());
+		if (settings.autoThreshold) {
+			thresholdController.reportDetections(fiducialFinder.lastCandidateCount(),
+				fiducialFinder.lastValidCount());
+		}
+		settings.diagnostics = fiducialFinder.lastDiagnostics();
+		diagnosticsSummary.add(settings.diagnostics);
+		stageTimer.endStage(STAGE_TRACKING);
+
+		// Record the contrast image before the calibration aids are drawn into it
+		if (thresholdRecorder.isRecording()) {
+			thresholdRecorder.recordFrame(thresholdMat, frameTimestamp);
+		}
 
 		// Send TUIO message
-		tuioServer.sendMessage(fiducialFinder.trackedFiducials);
+		if (tuioUpsampler != NULL) {
+			tuioUpsampler->update(fiducialFinder.trackedFiducials);
+		} else {
+			tuioServer.sendMessage(fiducialFinder.trackedFiducials);
+		}
+		if (blobs) {
+			tuioServer.sendBlobs(fiducialFinder.trackedBlobs());
+		}
 
 		// Display the contrast image in a window
-        if (showContrastWindow) {
-			displayContrastImage(thresholdMat, recordMode, arenaRadius);
+        if (showContrastWindow && updateWindows && loadLevel < LOAD_NO_CONTRAST_WINDOW) {
+			displayContrastImage(thresholdMat, recordMode, settings.arenaRadius);
 		}
 
 		// Print fiducial data
-		if (printData) {
+		if (settings.print) {
 			printFiducials(fiducialFinder.trackedFiducials);
 		}
+		stageTimer.endStage(STAGE_OUTPUT);
+
+		// Record the frame before tracking information is drawn into it,
+		// so the recorded video can be replayed through the tracking pipeline
+		if (recordMode == RECORDING) {
+			cameraRecorder.recordFrame(flipMat);
+		}
 
 		// Draw tracking information in the image to be displayed
-		if (cameraDisplay != NULL && recordMode != PLAYBACK) {
+		if (cameraDisplay != NULL && recordMode != PLAYBACK && updateWindows) {
 			displayMat = flipMat;
 			cameraDisplay->drawTrackingInfo(displayMat, fiducialFinder.trackedFiducials);
 			cameraDisplay->displayTrackedImage(displayMat);
 		}
 
-		// Record or play back video
-		switch (recordMode) {
-		case RECORDING:
-			cameraRecorder.recordFrame(displayMat);
-			break;
-		case PLAYBACK:
+		// Play back video
+		if (recordMode == PLAYBACK) {
 			Mat playbackMat;
 			cameraRecorder.playbackFrame(playbackMat);
-			cameraDisplay->displayTrackedImage(playbackMat);
-			break;
+			if (updateWindows) {
+				cameraDisplay->displayTrackedImage(playbackMat);
+			}
+		}
+		stageTimer.endStage(STAGE_DISPLAY);
+
+		if (useGovernor && loadGovernor.update(stageTimer)) {
+			std::cout << "Load level " << loadGovernor.level() << ": "
+				<< LoadGovernor::levelName(loadGovernor.level()) << "\n";
 		}
 
 		double frameEndClock = clock() * CLOCK_FACTOR;
 		int waitTime = frameTime - (int) (frameEndClock - frameStartClock + 0.5);
 		// Caution: waitTime <= 0 means to wait forever
-		if (waitTime <= 0) {
+		if (waitTime <= 0 || replayFast) {
 			waitTime = 1;
 		}
 
-		// Check user input to console
-		int key = waitKey(waitTime);
+		// Check user input to console, unless there is no window that could receive it
+		int key = -1;
+		if (!replayFast || cameraDisplay != NULL || showContrastWindow) {
+			key = waitKey(waitTime);
+		}
+		// Commands received on the control port are handled like the corresponding keys
+		switch (command) {
+		case COMMAND_START_RECORDING:
+			key = 'r';
+			break;
+		case COMMAND_STOP_RECORDING:
+			key = 's';
+			break;
+		case COMMAND_QUIT:
+			key = 'q';
+			break;
+		}
 		switch(key) {
 		case 27:
 		case 'q':
@@ -233,6 +494,10 @@ void process(std::unordered_map<std::string, std::string> &parameters) {
 			if (recordMode == NORMAL) {
 				if (cameraRecorder.startRecording()) {
 					recordMode = RECORDING;
+					if (recordContrast) {
+						thresholdRecorder.startRecording(
+							cameraRecorder.getRecordingFileName(RLE_FILE_EXT), trackedFrameSize);
+					}
 				}
 			}
 			break;
@@ -241,6 +506,7 @@ void process(std::unordered_map<std::string, std::string> &parameters) {
 			switch (recordMode) {
 			case RECORDING:
 				cameraRecorder.stopRecording();
+				thresholdRecorder.stopRecording();
 				break;
 			case PLAYBACK:
 				cameraRecorder.stopPlayback();
@@ -253,6 +519,7 @@ void process(std::unordered_map<std::string, std::string> &parameters) {
 			switch (recordMode) {
 			case RECORDING:
 				cameraRecorder.stopRecording();
+				thresholdRecorder.stopRecording();
 				// fall through
 			case NORMAL:
 				if (cameraDisplay == NULL) {
@@ -269,12 +536,24 @@ void process(std::unordered_map<std::string, std::string> &parameters) {
 	switch (recordMode) {
 	case RECORDING:
 		cameraRecorder.stopRecording();
+		thresholdRecorder.stopRecording();
 		break;
 	case PLAYBACK:
 		cameraRecorder.stopPlayback();
 		break;
 	}
+	if (controlServer != NULL) {
+		delete controlServer;
+	}
+	if (tuioUpsampler != NULL) {
+		delete tuioUpsampler;
+	}
 	if (cameraDisplay != NULL) {
 		delete cameraDisplay;
 	}
+	if (replay) {
+		std::cout << "Fiducial engine " << engineName << "\n";
+		stageTimer.printSummary();
+		diagnosticsSummary.print();
+	}
 }
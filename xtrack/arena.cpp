@@ -0,0 +1,139 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Restricting the processing to the pixels inside the arena
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include "arena.h"
+
+ArenaMask::ArenaMask(const std::string &definition, cv::Size frameSize) {
+	this->frameSize = frameSize;
+	this->radius = -1;
+	if (definition.empty()) {
+		this->shape = ARENA_NONE;
+	} else if (definition == "circle") {
+		this->shape = ARENA_CIRCLE;
+	} else if (isdigit(definition[0])) {
+		this->shape = ARENA_POLYGON;
+		std::istringstream stream(definition);
+		int x, y;
+		char separator;
+		while (stream >> x >> separator >> y) {
+			polygon.push_back(cv::Point(x, y));
+			if (!(stream >> separator)) {
+				break;
+			}
+		}
+		if (polygon.size() < 3 || !stream.eof()) {
+			std::cerr << "Invalid arena polygon " << definition << ", use x1,y1,x2,y2,x3,y3,...\n";
+			throw 1;
+		}
+	} else {
+		this->shape = ARENA_BITMAP;
+		bitmap = cv::imread(definition, 0);
+		if (bitmap.empty()) {
+			std::cerr << "Could not read the arena mask " << definition << "\n";
+			throw 1;
+		}
+	}
+}
+
+bool ArenaMask::isEnabled() {
+	return shape != ARENA_NONE;
+}
+
+void ArenaMask::update(cv::Size size, int radius) {
+	if (shape == ARENA_NONE || (size == this->size && (shape != ARENA_CIRCLE || radius == this->radius))) {
+		return;
+	}
+	this->size = size;
+	this->radius = radius;
+
+	cv::Mat mask(size, CV_8UC1, cv::Scalar(0));
+	float scale = (float) size.width / frameSize.width;
+	switch (shape) {
+	case ARENA_CIRCLE:
+		cv::circle(mask, cv::Point(size.width / 2, size.height / 2), (int) (radius * scale),
+			cv::Scalar(255), CV_FILLED);
+		break;
+	case ARENA_POLYGON: {
+		std::vector<cv::Point> points(polygon.size());
+		for (size_t i = 0; i < polygon.size(); i++) {
+			points[i] = cv::Point((int) (polygon[i].x * scale), (int) (polygon[i].y * scale));
+		}
+		const cv::Point *corners = &points[0];
+		int count = (int) points.size();
+		cv::fillPoly(mask, &corners, &count, 1, cv::Scalar(255));
+		break;
+	}
+	case ARENA_BITMAP:
+		cv::resize(bitmap, mask, size, 0, 0, cv::INTER_NEAREST);
+		break;
+	default:
+		break;
+	}
+	buildSpans(mask);
+}
+
+void ArenaMask::buildSpans(const cv::Mat &mask) {
+	spanStarts.clear();
+	spans.clear();
+	for (int y = 0; y < mask.rows; y++) {
+		spanStarts.push_back((int) spans.size());
+		const unsigned char *row = mask.ptr(y);
+		int x = 0;
+		while (x < mask.cols) {
+			while (x < mask.cols && row[x] <= 127) {
+				x++;
+			}
+			ArenaSpan span;
+			span.start = x;
+			while (x < mask.cols && row[x] > 127) {
+				x++;
+			}
+			span.end = x;
+			if (span.end > span.start) {
+				spans.push_back(span);
+			}
+		}
+	}
+	spanStarts.push_back((int) spans.size());
+}
+
+void ArenaMask::threshold(const cv::Mat &grayscale, cv::Mat &output, int threshold, const cv::Rect &roi) {
+	output.create(grayscale.size(), CV_8UC1);
+	for (int y = 0; y < grayscale.rows; y++) {
+		const unsigned char *source = grayscale.ptr(y);
+		unsigned char *dest = output.ptr(y);
+		memset(dest, 0, grayscale.cols);
+		if (y < roi.y || y >= roi.y + roi.height) {
+			continue;
+		}
+		for (int i = spanStarts[y]; i < spanStarts[y + 1]; i++) {
+			int start = std::max(spans[i].start, roi.x);
+			int end = std::min(spans[i].end, roi.x + roi.width);
+			for (int x = start; x < end; x++) {
+				dest[x] = source[x] > threshold ? 255 : 0;
+			}
+		}
+	}
+}
+
+void ArenaMask::clear(cv::Mat &image) {
+	for (int y = 0; y < image.rows; y++) {
+		unsigned char *row = image.ptr(y);
+		int x = 0;
+		for (int i = spanStarts[y]; i < spanStarts[y + 1]; i++) {
+			memset(row + x, 0, spans[i].start - x);
+			x = spans[i].end;
+		}
+		memset(row + x, 0, image.cols - x);
+	}
+}
@@ -0,0 +1,59 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Restricting the processing to the pixels inside the arena
+
+#pragma once
+
+#include "stdafx.h"
+
+enum ArenaShape {
+	ARENA_NONE, ARENA_CIRCLE, ARENA_POLYGON, ARENA_BITMAP
+};
+
+// The first pixel inside and the first pixel outside the arena in a row
+struct ArenaSpan {
+	int start;
+	int end;
+};
+
+// A mask for the tracked frames that is stored as spans of arena pixels in each row. Pixels outside
+// the arena are set to black when thresholding, so they are treated as background connected to the
+// frame border, and the bit-packed segmentation passes over them without visiting single pixels.
+class ArenaMask {
+public:
+	// The definition is empty for no mask, 'circle' for a circle around the frame center with the
+	// arena radius, a list of polygon corners 'x1,y1,x2,y2,...' in frame pixels, or the name of an
+	// image file with the size of the frame in which the arena is white.
+	ArenaMask(const std::string &definition, cv::Size frameSize);
+
+	// Is a mask defined?
+	bool isEnabled();
+	// Rebuild the mask if the image size or the arena radius (in frame pixels) have changed.
+	// The image may be smaller than the frame, e.g. when it has been downscaled.
+	void update(cv::Size size, int radius);
+	// Threshold the pixels of the grayscale image that lie inside both the arena and the region of
+	// interest, and set all other pixels of the output to black.
+	void threshold(const cv::Mat &grayscale, cv::Mat &output, int threshold, const cv::Rect &roi);
+	// Set the pixels outside the arena to black.
+	void clear(cv::Mat &image);
+
+private:
+	ArenaShape shape;
+	cv::Size frameSize;
+	std::vector<cv::Point> polygon;
+	cv::Mat bitmap;
+	// The image size and radius for which the spans have been built
+	cv::Size size;
+	int radius;
+	// The spans of row y are stored from spanStarts[y] to spanStarts[y + 1] - 1
+	std::vector<int> spanStarts;
+	std::vector<ArenaSpan> spans;
+
+	void buildSpans(const cv::Mat &mask);
+};
@@ -0,0 +1,197 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Automatic adaption of the threshold to changing lighting conditions
+
+#include <cstdlib>
+#include <cstring>
+#include "autothreshold.h"
+
+// The approximate number of pixels sampled for the histogram
+static const int HISTOGRAM_SAMPLES = 65536;
+// The weight of the current frame when smoothing the histogram threshold
+static const float SMOOTHING_FACTOR = 0.1f;
+// Threshold changes smaller than this are ignored
+static const int HYSTERESIS = 3;
+// The offset search changes the offset by this step every SEARCH_INTERVAL frames
+static const int SEARCH_STEP = 4;
+static const int SEARCH_INTERVAL = 5;
+// The maximal absolute offset
+static const int MAX_OFFSET = 40;
+// After this number of frames without any candidates the offset is reduced by one
+static const int DECAY_INTERVAL = 30;
+// The range of thresholds that can be selected
+static const int MIN_THRESHOLD = 10;
+static const int MAX_THRESHOLD = 245;
+
+ThresholdController::ThresholdController() {
+	this->smoothedThreshold = -1;
+	this->offset = 0;
+	this->offsetChanged = false;
+	this->emptyFrames = 0;
+	this->searching = false;
+	this->searchStart = 0;
+	this->searchDirection = 1;
+	this->searchFrames = 0;
+	this->bestOffset = 0;
+	this->bestValid = 0;
+	this->bestLost = 0;
+	this->settledValid = 0;
+	this->settledLost = 0;
+}
+
+int ThresholdController::computeThreshold(cv::InputArray grayScale, int currentThreshold) {
+	cv::Mat image = grayScale.getMat();
+	computeHistogram(image);
+	int sampleCount = 0;
+	for (int i = 0; i < 256; i++) {
+		sampleCount += histogram[i];
+	}
+	int frameThreshold = otsuThreshold(sampleCount);
+	if (smoothedThreshold < 0) {
+		smoothedThreshold = (float) frameThreshold;
+	} else {
+		smoothedThreshold += SMOOTHING_FACTOR * (frameThreshold - smoothedThreshold);
+	}
+
+	int target = (int) (smoothedThreshold + 0.5f) + offset;
+	if (target < MIN_THRESHOLD) {
+		target = MIN_THRESHOLD;
+	} else if (target > MAX_THRESHOLD) {
+		target = MAX_THRESHOLD;
+	}
+	// Steps of the offset search are always applied, drifts of the histogram only when they are large enough
+	if (offsetChanged || abs(target - currentThreshold) >= HYSTERESIS) {
+		offsetChanged = false;
+		return target;
+	}
+	return currentThreshold;
+}
+
+void ThresholdController::reportDetections(int candidates, int valid) {
+	int lost = candidates - valid;
+	if (!searching) {
+		if (candidates == 0) {
+			// Nothing to learn from: slowly return to the histogram threshold
+			if (++emptyFrames >= DECAY_INTERVAL) {
+				emptyFrames = 0;
+				if (offset != 0) {
+					offset += offset > 0 ? -1 : 1;
+					offsetChanged = true;
+					settledValid = 0;
+					settledLost = 0;
+				}
+			}
+			return;
+		}
+		emptyFrames = 0;
+		if (valid >= settledValid && lost <= settledLost) {
+			// Nothing got worse since the last search: keep the current offset
+			settledValid = valid;
+			return;
+		}
+		// Fiducials were lost or new ones are not recognized: sweep the offsets, first upwards
+		// from the current one, then downwards
+		searching = true;
+		searchStart = offset;
+		searchDirection = 1;
+		searchFrames = 0;
+		bestOffset = offset;
+		bestValid = valid;
+		bestLost = lost;
+	}
+
+	if (lost == 0 && valid >= bestValid) {
+		// All candidates are recognized: keep the current offset
+		searching = false;
+		settledValid = valid;
+		settledLost = 0;
+		return;
+	}
+	if (++searchFrames < SEARCH_INTERVAL) {
+		return;
+	}
+	searchFrames = 0;
+	// Offsets that are not better than an earlier one are not kept, so the search does not move
+	// away from an offset that worked
+	if (valid > bestValid) {
+		bestOffset = offset;
+		bestValid = valid;
+		bestLost = lost;
+	}
+	offset += searchDirection * SEARCH_STEP;
+	if (offset > MAX_OFFSET) {
+		searchDirection = -1;
+		offset = searchStart - SEARCH_STEP;
+	}
+	if (offset < -MAX_OFFSET) {
+		// The whole range has been swept: return to the best offset and stop until the
+		// detections get worse
+		searching = false;
+		offset = bestOffset;
+		settledValid = bestValid;
+		settledLost = bestLost;
+	}
+	offsetChanged = true;
+}
+
+void ThresholdController::computeHistogram(const cv::Mat &image) {
+	int step = (int) sqrt((double) image.cols * image.rows / HISTOGRAM_SAMPLES);
+	if (step < 1) {
+		step = 1;
+	}
+
+	// Four partial histograms avoid stalls when consecutive samples fall into the same bin
+	int partial[4][256];
+	memset(partial, 0, sizeof(partial));
+	for (int y = step / 2; y < image.rows; y += step) {
+		const unsigned char *row = image.ptr(y);
+		int x = step / 2;
+		for (; x + 3 * step < image.cols; x += 4 * step) {
+			partial[0][row[x]]++;
+			partial[1][row[x + step]]++;
+			partial[2][row[x + 2 * step]]++;
+			partial[3][row[x + 3 * step]]++;
+		}
+		for (; x < image.cols; x += step) {
+			partial[0][row[x]]++;
+		}
+	}
+	for (int i = 0; i < 256; i++) {
+		histogram[i] = partial[0][i] + partial[1][i] + partial[2][i] + partial[3][i];
+	}
+}
+
+int ThresholdController::otsuThreshold(int sampleCount) {
+	double totalSum = 0;
+	for (int i = 0; i < 256; i++) {
+		totalSum += (double) i * histogram[i];
+	}
+
+	// Select the threshold maximizing the variance between the dark and the bright class
+	double darkSum = 0;
+	int darkCount = 0;
+	double maxVariance = -1;
+	int result = 128;
+	for (int t = 0; t < 255; t++) {
+		darkCount += histogram[t];
+		darkSum += (double) t * histogram[t];
+		int brightCount = sampleCount - darkCount;
+		if (darkCount == 0 || brightCount == 0) {
+			continue;
+		}
+		double meanDiff = darkSum / darkCount - (totalSum - darkSum) / brightCount;
+		double variance = (double) darkCount * brightCount * meanDiff * meanDiff;
+		if (variance > maxVariance) {
+			maxVariance = variance;
+			// Pixels brighter than the threshold are white
+			result = t;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Tracking of untagged objects as blobs of the contrast image
+
+#include <algorithm>
+#include "blobs.h"
+#include "fiducials.h"
+
+// The grid cell containing the given position (in frame pixels), positions outside the frame
+// belong to the border cells
+static int cellIndex(float x, float y, int cell, int columns, int rows) {
+	int column = std::max(0, std::min((int) x / cell, columns - 1));
+	int row = std::max(0, std::min((int) y / cell, rows - 1));
+	return row * columns + column;
+}
+
+BlobTracker::BlobTracker() {
+	maxDistance = 0;
+	// The session ids of the fiducials are their ids
+	nextSessionId = MAX_FIDUCIALS;
+	timestamp = 0.0;
+}
+
+void BlobTracker::setMaxDistance(int maxDistance) {
+	this->maxDistance = maxDistance;
+}
+
+const std::vector<TrackedBlob> &BlobTracker::trackedBlobs() {
+	return tracked;
+}
+
+void BlobTracker::update(const Blob blobs[], int count, cv::Size fsize, double timestamp) {
+	double secTime = timestamp / 1000;
+	float timeDiff = (float) (secTime - this->timestamp);
+	int cell = std::max(1, maxDistance);
+	int columns = fsize.width / cell + 1;
+	int rows = fsize.height / cell + 1;
+	int trackedCount = (int) tracked.size();
+
+	// Sort the tracked blobs into the grid cells by counting them per cell
+	cellStarts.assign(columns * rows + 1, 0);
+	cellBlobs.resize(trackedCount);
+	for (int i = 0; i < trackedCount; i++) {
+		cellStarts[cellIndex(tracked[i].x * fsize.width, tracked[i].y * fsize.height, cell, columns, rows)]++;
+	}
+	for (int i = 1; i <= columns * rows; i++) {
+		cellStarts[i] += cellStarts[i - 1];
+	}
+	for (int i = 0; i < trackedCount; i++) {
+		int index = cellIndex(tracked[i].x * fsize.width, tracked[i].y * fsize.height, cell, columns, rows);
+		cellBlobs[--cellStarts[index]] = i;
+	}
+
+	// Collect the tracked blobs within the maximal distance of each new blob from the neighbouring cells
+	pairs.clear();
+	float maxSquare = (float) maxDistance * maxDistance;
+	for (int i = 0; i < count; i++) {
+		int column = std::max(0, std::min((int) blobs[i].x / cell, columns - 1));
+		int row = std::max(0, std::min((int) blobs[i].y / cell, rows - 1));
+		for (int y = std::max(0, row - 1); y <= std::min(row + 1, rows - 1); y++) {
+			for (int x = std::max(0, column - 1); x <= std::min(column + 1, columns - 1); x++) {
+				int index = y * columns + x;
+				for (int j = cellStarts[index]; j < cellStarts[index + 1]; j++) {
+					const TrackedBlob &old = tracked[cellBlobs[j]];
+					float dx = blobs[i].x - old.x * fsize.width;
+					float dy = blobs[i].y - old.y * fsize.height;
+					float distance = dx * dx + dy * dy;
+					if (distance <= maxSquare) {
+						BlobPair pair = { distance, i, cellBlobs[j] };
+						pairs.push_back(pair);
+					}
+				}
+			}
+		}
+	}
+
+	// Associate the closest pairs first
+	std::sort(pairs.begin(), pairs.end());
+	matches.assign(count, -1);
+	trackedMatched.assign(trackedCount, false);
+	for (size_t i = 0; i < pairs.size(); i++) {
+		if (matches[pairs[i].blob] < 0 && !trackedMatched[pairs[i].tracked]) {
+			matches[pairs[i].blob] = pairs[i].tracked;
+			trackedMatched[pairs[i].tracked] = true;
+		}
+	}
+
+	// Blobs without a match start a new session, tracked blobs without a match are dropped
+	updated.resize(count);
+	for (int i = 0; i < count; i++) {
+		TrackedBlob &blob = updated[i];
+		blob.x = blobs[i].x / fsize.width;
+		blob.y = blobs[i].y / fsize.height;
+		blob.width = blobs[i].width / fsize.width;
+		blob.height = blobs[i].height / fsize.height;
+		blob.area = blobs[i].area / (fsize.width * fsize.height);
+		if (matches[i] < 0) {
+			blob.sessionId = nextSessionId++;
+			blob.xspeed = 0;
+			blob.yspeed = 0;
+			blob.xyacc = 0;
+			continue;
+		}
+
+		const TrackedBlob &old = tracked[matches[i]];
+		blob.sessionId = old.sessionId;
+		blob.xspeed = old.xspeed;
+		blob.yspeed = old.yspeed;
+		blob.xyacc = old.xyacc;
+		if (timeDiff > 0) {
+			blob.xspeed = (blob.x - old.x) / timeDiff;
+			blob.yspeed = (blob.y - old.y) / timeDiff;
+			float oldSpeed = sqrt(old.xspeed * old.xspeed + old.yspeed * old.yspeed);
+			float newSpeed = sqrt(blob.xspeed * blob.xspeed + blob.yspeed * blob.yspeed);
+			blob.xyacc = (newSpeed - oldSpeed) / timeDiff;
+		}
+	}
+	tracked.swap(updated);
+	this->timestamp = secTime;
+}
@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Receiving OSC messages for changing parameters at runtime using WOscLib (http://wosclib.sourceforge.net/)
+
+#pragma once
+
+#include "stdafx.h"
+#include "threads.h"
+#include "diagnostics.h"
+#include "WOscReceiver.h"
+
+// The parameters that can be changed at runtime.
+struct ControlSettings {
+	int threshold;
+	bool autoThreshold;
+	bool rotate;
+	int arenaRadius;
+	int trackRectSize;
+	bool print;
+	// The region of the tracked frame where fiducials are searched. An empty rectangle means
+	// the whole frame.
+	cv::Rect roi;
+	// Only reported, cannot be changed: the current level of the load governor
+	int loadLevel;
+	// Only reported, cannot be changed: the tracking diagnostics of the last frame
+	TrackingDiagnostics diagnostics;
+};
+
+enum ControlCommand {
+	COMMAND_NONE, COMMAND_START_RECORDING, COMMAND_STOP_RECORDING, COMMAND_QUIT
+};
+
+// Receives OSC messages on a background thread. The received changes are collected and
+// transferred to the processing loop with 'applyChanges', which is called between frames.
+class ControlServer : public WOscReceiver, private Thread {
+public:
+	ControlServer(std::unordered_map<std::string, std::string> &parameters, const ControlSettings &settings);
+	~ControlServer();
+
+	// Copy the settings changed since the last call into the given settings and return the
+	// last received command. If nothing has been received, the given settings are taken over
+	// as the current state instead. Nothing is changed if the receiver thread is currently
+	// processing a message, so the caller is never blocked; the changes are then applied on
+	// the next call.
+	ControlCommand applyChanges(ControlSettings &settings);
+
+	void NetworkSend(const char *data, int dataLen, const WOscNetReturn *networkReturnAddress);
+
+protected:
+	void run();
+	void HandleOffendingPackets(const char * const data, int dataLen, const WOscException &exception);
+	void HandleNonmatchedMessages(const WOscMessage *msg, const WOscNetReturn *networkReturnAddress);
+
+private:
+	friend class ControlMethod;
+
+	unsigned short port;
+	int sock;
+	Mutex mutex;
+	ControlSettings pendingSettings;
+	ControlCommand pendingCommand;
+	bool changed;
+	bool stopRequested;
+
+	void handleMessage(int method, const WOscMessage *msg, const WOscNetReturn *networkReturnAddress);
+};
@@ -8,26 +8,236 @@
 
 // Fiducial tracking using libfidtrack (http://reactivision.sourceforge.net/)
 
+#include <algorithm>
+#include <cstring>
 #include "fiducials.h"
+#include "threshold.h"
+#include "realtime.h"
+
+// The whole frame is searched at least once within this number of frames when window tracking is enabled
+static const int SEARCH_INTERVAL = 10;
+// The side length of search windows relative to the size of the tracked fiducial
+static const float WINDOW_FACTOR = 2.0f;
+// The side length of windows around candidates found in a downsampled image, relative to their size
+static const float REFINE_FACTOR = 1.25f;
+// Window side lengths are rounded up to power of two multiples of this value, limiting the number of detectors
+static const int WINDOW_QUANTUM = 64;
+// The detectors of windows and downsampled frames together have at most the pixels of this number of
+// full frames, the least recently used ones are freed beyond
+static const int MAX_DETECTOR_FRAMES = 2;
+// The side length of the tiles in which frames are compared in incremental mode
+static const int CHANGE_TILE_SIZE = 32;
+// The minimal distance in pixels between the changed tiles and the border of the search window
+static const int MIN_CHANGE_MARGIN = 64;
+// The number of separate areas of changed tiles searched in windows of their own in incremental mode,
+// more areas are searched in the whole frame
+static const int MAX_CHANGE_AREAS = 4;
+// The whole frame is searched at least once within this number of frames in incremental mode,
+// which finds fiducials that are larger than the margin around the changed tiles
+static const int FULL_SEARCH_INTERVAL = 50;
 
 bool isNaN(float f) {
 	return f != f;
 }
 
-FiducialFinder::FiducialFinder(cv::Size &fsize) {
-	this->fsize = fsize;
-	initialize_treeidmap(&treeidmap);
+// Does the bounding box of the fiducial (in full frame pixels) overlap the area (in pixels of
+// a frame downscaled by the given factor)?
+static bool overlaps(const FiducialX &fiducial, const cv::Rect &area, float scale) {
+	float half = fiducial.root_size / 2 + 1;
+	return fiducial.x + half > area.x * scale && fiducial.x - half < (area.x + area.width) * scale
+		&& fiducial.y + half > area.y * scale && fiducial.y - half < (area.y + area.height) * scale;
+}
+
+// The smallest power of two multiple of the window quantum that is at least the given length,
+// or the frame side if that is not much larger. This limits the number of detectors.
+static int quantizedSide(int length, int frameSide) {
+	int side = WINDOW_QUANTUM;
+	while (side < length) {
+		side *= 2;
+	}
+	return 2 * side > frameSide ? frameSide : side;
+}
+
+// The part of the grayscale image corresponding to a window of the frame, if they have the same size
+static cv::Mat windowOf(const cv::Mat &grayscale, const cv::Mat &frame, const cv::Rect &window) {
+	return grayscale.size() == frame.size() ? cv::Mat(grayscale, window) : cv::Mat();
+}
+
+// Computes the positions of the fiducial candidates of a detector, one candidate per part
+class StatisticsTask : public ParallelTask {
+public:
+	StatisticsTask(FidtrackerX *fidtrackerx, FiducialX *fiducials, cv::Size size) {
+		this->fidtrackerx = fidtrackerx;
+		this->fiducials = fiducials;
+		this->size = size;
+	}
+
+	void runPart(int part) {
+		compute_fiducial_statisticsX(fidtrackerx, fiducials, part, 1, size.width, size.height);
+	}
+
+private:
+	FidtrackerX *fidtrackerx;
+	FiducialX *fiducials;
+	cv::Size size;
+};
+
+FiducialDetector::FiducialDetector(cv::Size &size, TreeIdMap *treeidmap) {
+	this->size = size;
+	dmap = NULL;
+	setPixelMap(new ShortPoint[size.height * size.width]);
+
+	initialize_fidtrackerX(&fidtrackerx, treeidmap, dmap);
+	// The root of a fidtrack120 fiducial is adjacent to its six symbols and its surrounding region
+	initialize_segmenter(&segmenter, size.width, size.height,
+		std::max(treeidmap->max_adjacencies, MAX_FIDUCIAL120_SYMBOLS + 1));
+	packed.resize(PACKED_ROW_WORDS(size.width) * size.height);
+	filterRows.resize(PACKED_FILTER_BUFFER_WORDS(size.width));
+	morphology = 0;
+	engine = ENGINE_FIDTRACKX;
+}
+
+FiducialDetector::~FiducialDetector() {
+	terminate_segmenter(&segmenter);
+	terminate_fidtrackerX(&fidtrackerx);
+	delete[] dmap;
+}
+
+void FiducialDetector::setPixelMap(ShortPoint *map) {
+	for (int y = 0; y < size.height; y++) {
+		for (int x = 0; x < size.width; x++) {
+			map[y * size.width + x].x = x;
+			map[y * size.width + x].y = y;
+		}
+	}
+	delete[] dmap;
+	dmap = map;
+	fidtrackerx.pixelwarp = map;
+}
 
-	dmap = new ShortPoint[fsize.height * fsize.width];
-	for (int y = 0; y < fsize.height; y++) {
-		for (int x = 0; x < fsize.width; x++) {
-			dmap[y * fsize.width + x].x = x;
-			dmap[y * fsize.width + x].y = y;
+int FiducialDetector::findCandidates(const cv::Mat &image, const cv::Mat &grayscale, FiducialX *fiducials, int maxCount,
+		TrackingDiagnostics &diagnostics, WorkerPool *workers) {
+	double tickPeriod = 1000.0 / cv::getTickFrequency();
+	int64 startTick = cv::getTickCount();
+
+	// Segmenting a bit-packed image only visits the pixels where the colour changes
+	packed_threshold_filtered(image.data, (int) image.step, &packed[0], &filterRows[0], size.width, size.height, 127,
+		morphology);
+	int64 thresholdTick = cv::getTickCount();
+	step_segmenter_packed(&segmenter, &packed[0]);
+	int64 segmentationTick = cv::getTickCount();
+	FidtrackerXStats stats120;
+	int num;
+	if (engine == ENGINE_FIDTRACK120) {
+		num = findCandidates120(fiducials, maxCount, stats120);
+	} else {
+		set_grayscale_imageX(&fidtrackerx, grayscale.size() == size ? grayscale.data : NULL, (int) grayscale.step);
+		num = find_fiducial_candidatesX(fiducials, maxCount, &fidtrackerx, &segmenter);
+		if (workers != NULL && num > 1) {
+			StatisticsTask task(&fidtrackerx, fiducials, size);
+			workers->run(task, num);
+		} else {
+			compute_fiducial_statisticsX(&fidtrackerx, fiducials, 0, num, size.width, size.height);
+		}
+	}
+	int64 recognitionTick = cv::getTickCount();
+
+	diagnostics.add(segmenter.stats, engine == ENGINE_FIDTRACK120 ? stats120 : fidtrackerx.stats);
+	diagnostics.times[PHASE_THRESHOLD] += (thresholdTick - startTick) * tickPeriod;
+	diagnostics.times[PHASE_SEGMENTATION] += (segmentationTick - thresholdTick) * tickPeriod;
+	diagnostics.times[PHASE_RECOGNITION] += (recognitionTick - segmentationTick) * tickPeriod;
+	return num;
+}
+
+// Find the fidtrack120 fiducials and convert them, taking the sizes from the root regions and their leaves
+int FiducialDetector::findCandidates120(FiducialX *fiducials, int maxCount, FidtrackerXStats &stats) {
+	memset(&stats, 0, sizeof(stats));
+	if (maxCount <= 0) {
+		return 0;
+	}
+	fiducials120.resize(maxCount);
+	int num = find_fiducials120(&fiducials120[0], maxCount, &topology, &segmenter);
+	stats.saturated_count = segmenter.stats.saturated_region_count;
+	stats.fragmented_count = segmenter.stats.fragmented_region_count;
+	stats.candidate_count = num;
+
+	// The fiducials are in the order of the root regions
+	Region *root = topology.root_regions_head.next;
+	for (int i = 0; i < num; i++, root = root->next) {
+		Fiducial120 &found = fiducials120[i];
+		FiducialX &fiducial = fiducials[i];
+		if (found.id == INVALID_FIDUCIAL120_ID) {
+			fiducial.id = INVALID_FIDUCIAL_ID;
+			stats.invalid_id_count++;
+		} else {
+			fiducial.id = found.id;
+		}
+		fiducial.x = found.x;
+		fiducial.y = found.y;
+		// fidtrack120 measures angles counterclockwise with the y axis pointing up
+		fiducial.angle = found.angle > 0 ? 2 * PI - found.angle : 0;
+		fiducial.root_size = (float) std::max(root->right - root->left, root->bottom - root->top);
+		fiducial.root_colour = root->colour;
+
+		float leafSizes = 0;
+		int leafCount = 0;
+		for (int j = 0; j < root->adjacent_region_count; j++) {
+			Region *container = root->adjacent_regions[j];
+			if (container->level != LEAF_CONTAINER_LEVEL) {
+				continue;
+			}
+			for (int k = 0; k < container->adjacent_region_count; k++) {
+				Region *leaf = container->adjacent_regions[k];
+				if (leaf->level == LEAF_LEVEL) {
+					leafSizes += ((leaf->bottom - leaf->top) + (leaf->right - leaf->left)) * .5f;
+					leafCount++;
+				}
+			}
 		}
+		fiducial.leaf_size = leafCount > 0 ? leafSizes / leafCount : 0;
+		fiducial.node_count = 1 + MAX_FIDUCIAL120_SYMBOLS + leafCount;
 	}
+	return num;
+}
+
+int FiducialDetector::findRegions(RegionX *regions, int maxCount, int minSize, int maxSize) {
+	return find_regionsX(regions, maxCount, &fidtrackerx, &segmenter, size.width, size.height, minSize, maxSize);
+}
 
-	initialize_fidtrackerX(&fidtrackerx, &treeidmap, dmap);
-	initialize_segmenter(&segmenter, fsize.width, fsize.height, treeidmap.max_adjacencies);
+FiducialFinder::FiducialFinder(cv::Size &fsize, const std::string &treeFile) {
+	this->fsize = fsize;
+	if (treeFile.empty()) {
+		initialize_treeidmap(&treeidmap);
+	} else {
+		initialize_treeidmap_from_file(&treeidmap, treeFile.c_str());
+		if (treeidmap.tree_count == 0) {
+			std::cerr << "Could not read the fiducial trees from " << treeFile << "\n";
+			throw 1;
+		}
+	}
+	detectors.push_back(new FiducialDetector(fsize, &treeidmap));
+	candidateCount = 0;
+	validCount = 0;
+	diagnostics.clear();
+	windowTracking = false;
+	framesSinceSearch = 0;
+	pyramidFactor = 1;
+	incremental = false;
+	framesSinceFullSearch = 0;
+	deferredRegions = 0;
+	noiseGate = 0;
+	morphology = 0;
+	engine = ENGINE_FIDTRACKX;
+	workers = NULL;
+	approximateDistance = 0;
+	approximateBudget = 0;
+	remainingBudget = 0;
+	blobTracking = false;
+	blobMinSize = 0;
+	blobMaxSize = 0;
+	blobColour = 255;
+	blobCount = -1;
+	previousCount = 0;
 
 	for (int i = 0; i < MAX_FIDUCIALS; i++) {
 		TrackedFiducial &trackedFid = trackedFiducials[i];
@@ -42,31 +252,56 @@ FiducialFinder::FiducialFinder(cv::Size &fsize) {
 		trackedFid.aspeed = nan;
 		trackedFid.xyacc = nan;
 		trackedFid.aacc = nan;
+		fiducialSizes[i] = 0;
 	}
 }
 
 FiducialFinder::~FiducialFinder() {
-	terminate_segmenter(&segmenter);
-	terminate_fidtrackerX(&fidtrackerx);
+	for (size_t i = 0; i < detectors.size(); i++) {
+		delete detectors[i];
+	}
 	terminate_treeidmap(&treeidmap);
-	delete dmap;
+	delete workers;
 }
 
-int FiducialFinder::findFiducials(cv::InputArray input, double timestamp) {
+int FiducialFinder::findFiducials(cv::InputArray input, double timestamp, const cv::Mat &grayscale) {
 	cv::Mat frame = input.getMat();
-	step_segmenter(&segmenter, frame.data);
-	int num = find_fiducialsX(rawFiducials, MAX_FIDUCIALS,
-			&fidtrackerx, &segmenter, frame.cols, frame.rows);
+	float scale = (float) fsize.width / frame.cols;
+	int num = 0;
+	diagnostics.clear();
+	remainingBudget = approximateBudget;
+	blobCount = -1;
+	if (windowTracking && framesSinceSearch < SEARCH_INTERVAL) {
+		num = detectInWindows(frame, grayscale, scale);
+	}
+	if (num == 0) {
+		if (pyramidFactor > 1) {
+			num = detectPyramid(frame, grayscale, scale);
+		} else if (incremental) {
+			num = detectChanges(frame, grayscale, scale);
+		} else {
+			num = detectFrame(frame, grayscale, scale, rawFiducials, MAX_FIDUCIALS);
+		}
+		framesSinceSearch = 0;
+	}
 
 	// Transfer the raw fiducial data to the tracked fiducial data and derive speed values
 	double secTime = timestamp / 1000;
 	int tracked = 0;
+	candidateCount = num;
+	validCount = 0;
 	for (int i = 0; i < num; i++) {
 		FiducialX &fidx = rawFiducials[i];
+		if (fidx.id != INVALID_FIDUCIAL_ID) {
+			validCount++;
+		}
 		if (fidx.id >= 0 && fidx.id < MAX_FIDUCIALS) {
 			TrackedFiducial &trackedFid = trackedFiducials[fidx.id];
 			if (!trackedFid.isTracked || trackedFid.timestamp != secTime) {
 				trackedFid.isTracked = true;
+				// Only the first candidate of each id in this frame is tracked and counted
+				tracked++;
+				fiducialSizes[fidx.id] = fidx.root_size;
 				float timeDiff = (float) (secTime - trackedFid.timestamp);
 				trackedFid.timestamp = secTime;
 
@@ -114,5 +349,494 @@ int FiducialFinder::findFiducials(cv::InputArray input, double timestamp) {
 			trackedFiducials[i].isTracked = false;
 		}
 	}
+
+	if (blobCount >= 0) {
+		blobTracker.update(blobs, blobCount, fsize, timestamp);
+	}
 	return tracked;
 }
+
+int FiducialFinder::lastCandidateCount() {
+	return candidateCount;
+}
+
+int FiducialFinder::lastValidCount() {
+	return validCount;
+}
+
+const TrackingDiagnostics &FiducialFinder::lastDiagnostics() {
+	return diagnostics;
+}
+
+void FiducialFinder::setWindowTracking(bool enabled) {
+	windowTracking = enabled;
+}
+
+void FiducialFinder::setPyramidFactor(int factor) {
+	pyramidFactor = factor;
+}
+
+void FiducialFinder::setIncremental(bool enabled) {
+	incremental = enabled;
+	previousFrame = cv::Mat();
+}
+
+void FiducialFinder::setDeferredRegions(int maxRegions) {
+	deferredRegions = maxRegions;
+	for (size_t i = 0; i < detectors.size(); i++) {
+		set_deferred_regionsX(&detectors[i]->fidtrackerx, maxRegions);
+	}
+}
+
+void FiducialFinder::setNoiseGate(int maxArea) {
+	noiseGate = maxArea;
+	for (size_t i = 0; i < detectors.size(); i++) {
+		set_noise_gate(&detectors[i]->segmenter, maxArea);
+	}
+}
+
+void FiducialFinder::setMorphology(int filter) {
+	morphology = filter;
+	for (size_t i = 0; i < detectors.size(); i++) {
+		detectors[i]->morphology = filter;
+	}
+}
+
+void FiducialFinder::setExpectedIds(const std::string &ids) {
+	expectedIds.clear();
+	std::istringstream stream(ids);
+	int first, last;
+	while (stream >> first) {
+		last = first;
+		if (stream.peek() == '-') {
+			stream.get();
+			if (!(stream >> last)) {
+				break;
+			}
+		}
+		for (int id = first; id <= last; id++) {
+			if (id < 0 || id >= MAX_FIDUCIALS) {
+				std::cerr << "Invalid expected id " << id << ", use 0 to " << MAX_FIDUCIALS - 1 << "\n";
+				throw 1;
+			}
+			expectedIds.push_back(id);
+		}
+		if (stream.peek() == ',') {
+			stream.get();
+		}
+	}
+	if (!stream.eof()) {
+		std::cerr << "Invalid expected ids " << ids << ", use e.g. 0,1,2,3 or 0-3\n";
+		throw 1;
+	}
+	for (size_t i = 0; i < detectors.size(); i++) {
+		setExpectedIds(detectors[i]);
+	}
+}
+
+void FiducialFinder::setExpectedIds(FiducialDetector *detector) {
+	set_expected_idsX(&detector->fidtrackerx, expectedIds.empty() ? NULL : &expectedIds[0], (int) expectedIds.size());
+}
+
+void FiducialFinder::setWorkerThreads(int threads, int firstCore, int priority) {
+	delete workers;
+	workers = threads > 0 ? new WorkerPool(threads, firstCore, priority) : NULL;
+}
+
+void FiducialFinder::setApproximateMatching(int maxDistance, int budget) {
+	approximateDistance = maxDistance;
+	approximateBudget = budget;
+}
+
+void FiducialFinder::setBlobTracking(bool enabled, int minSize, int maxSize, int colour, int maxDistance) {
+	blobTracking = enabled;
+	blobMinSize = minSize;
+	blobMaxSize = maxSize;
+	blobColour = colour;
+	blobTracker.setMaxDistance(maxDistance);
+}
+
+const std::vector<TrackedBlob> &FiducialFinder::trackedBlobs() {
+	return blobTracker.trackedBlobs();
+}
+
+void FiducialFinder::setEngine(FiducialEngine engine) {
+	this->engine = engine;
+	for (size_t i = 0; i < detectors.size(); i++) {
+		detectors[i]->engine = engine;
+	}
+}
+
+void FiducialFinder::prefaultBuffers(bool hugePages, bool lock) {
+	FiducialDetector *detector = detectors[0];
+	int pixels = fsize.width * fsize.height;
+	prefaultBuffer(detector->segmenter.label_parents, sizeof(int) * pixels, hugePages, lock);
+	prefaultBuffer(detector->segmenter.label_sizes, sizeof(int) * pixels, hugePages, lock);
+	prefaultBuffer(detector->segmenter.label_regions, sizeof(int) * pixels, hugePages, lock);
+	prefaultBuffer(detector->segmenter.live_regions, sizeof(int) * pixels, hugePages, lock);
+	prefaultBuffer(detector->segmenter.leaf_regions, sizeof(int) * pixels, hugePages, lock);
+	prefaultBuffer(detector->segmenter.regions, detector->segmenter.sizeof_region * pixels, hugePages, lock);
+	// Huge pages are only used for pages that have not been touched yet, so the pixel map is replaced
+	// by a new one that is filled after it has been prefaulted
+	ShortPoint *dmap = new ShortPoint[pixels];
+	prefaultBuffer(dmap, sizeof(ShortPoint) * pixels, hugePages, lock);
+	detector->setPixelMap(dmap);
+}
+
+FiducialDetector *FiducialFinder::getDetector(cv::Size size) {
+	for (size_t i = 0; i < detectors.size(); i++) {
+		if (detectors[i]->size == size) {
+			// Keep the detectors in the order of their last use, except the one of the full frame
+			FiducialDetector *detector = detectors[i];
+			if (i > 0) {
+				detectors.erase(detectors.begin() + i);
+				detectors.push_back(detector);
+			}
+			return detector;
+		}
+	}
+	FiducialDetector *detector = new FiducialDetector(size, &treeidmap);
+	set_deferred_regionsX(&detector->fidtrackerx, deferredRegions);
+	set_noise_gate(&detector->segmenter, noiseGate);
+	detector->morphology = morphology;
+	detector->engine = engine;
+	setExpectedIds(detector);
+	detectors.push_back(detector);
+
+	// Free the least recently used detectors when those of windows grow too large
+	int pixels = 0;
+	for (size_t i = 1; i < detectors.size(); i++) {
+		pixels += detectors[i]->size.width * detectors[i]->size.height;
+	}
+	while (pixels > MAX_DETECTOR_FRAMES * fsize.width * fsize.height && detectors.size() > 2) {
+		pixels -= detectors[1]->size.width * detectors[1]->size.height;
+		delete detectors[1];
+		detectors.erase(detectors.begin() + 1);
+	}
+	return detector;
+}
+
+int FiducialFinder::detect(const cv::Mat &image, const cv::Mat &grayscale, cv::Point2f offset, float scale,
+		FiducialX *fiducials, int maxCount) {
+	FiducialDetector *detector = getDetector(image.size());
+	int num = detector->findCandidates(image, grayscale, fiducials, maxCount, diagnostics, workers);
+
+	// Transform into coordinates of the full frame
+	for (int i = 0; i < num; i++) {
+		fiducials[i].x = offset.x + fiducials[i].x * scale;
+		fiducials[i].y = offset.y + fiducials[i].y * scale;
+		fiducials[i].leaf_size *= scale;
+		fiducials[i].root_size *= scale;
+	}
+	if (approximateDistance > 0 && engine == ENGINE_FIDTRACKX) {
+		matchApproximately(detector, fiducials, num);
+	}
+	return num;
+}
+
+// Search the whole frame or a downsampled copy of it. The blobs are found in the same segmentation,
+// before the detector is used for another image.
+int FiducialFinder::detectFrame(const cv::Mat &image, const cv::Mat &grayscale, float scale, FiducialX *fiducials,
+		int maxCount) {
+	int num = detect(image, grayscale, cv::Point2f(0, 0), scale, fiducials, maxCount);
+	if (blobTracking) {
+		findBlobs(getDetector(image.size()), scale, fiducials, num);
+	}
+	return num;
+}
+
+// Keep the regions of the blob colour that are not part of a fiducial candidate, in coordinates of the
+// full frame
+void FiducialFinder::findBlobs(FiducialDetector *detector, float scale, const FiducialX *fiducials, int num) {
+	int regionCount = detector->findRegions(blobRegions, MAX_BLOB_REGIONS, (int) (blobMinSize / scale),
+		(int) ceil(blobMaxSize / scale));
+	blobCount = 0;
+	for (int i = 0; i < regionCount && blobCount < MAX_BLOBS; i++) {
+		RegionX &region = blobRegions[i];
+		if (region.colour != blobColour) {
+			continue;
+		}
+		float x = (region.left + region.right) / 2.0f * scale;
+		float y = (region.top + region.bottom) / 2.0f * scale;
+		bool inFiducial = false;
+		for (int j = 0; j < num && !inFiducial; j++) {
+			float half = fiducials[j].root_size / 2;
+			inFiducial = std::abs(x - fiducials[j].x) <= half && std::abs(y - fiducials[j].y) <= half;
+		}
+		if (inFiducial) {
+			continue;
+		}
+
+		Blob &blob = blobs[blobCount++];
+		blob.x = x;
+		blob.y = y;
+		blob.width = region.width * scale;
+		blob.height = region.height * scale;
+		blob.area = blob.width * blob.height;
+	}
+	diagnostics.counters[COUNTER_BLOBS] += blobCount;
+}
+
+// The trees of the candidates are still in the region graph of the detector, as long as it is not used
+// for the next image.
+void FiducialFinder::matchApproximately(FiducialDetector *detector, FiducialX *fiducials, int num) {
+	for (int i = 0; i < num && remainingBudget > 0; i++) {
+		if (fiducials[i].id != INVALID_FIDUCIAL_ID) {
+			continue;
+		}
+		int trackedId = nearestTrackedFiducial(fiducials[i]);
+		if (trackedId == INVALID_FIDUCIAL_ID) {
+			continue;
+		}
+		// Trees often differ in a single node, so the tracked fiducial wins among equally close trees
+		int id = find_approximate_idX(&detector->fidtrackerx, i, approximateDistance, trackedId,
+			&remainingBudget);
+		if (id != INVALID_FIDUCIAL_ID) {
+			fiducials[i].id = id;
+			diagnostics.counters[COUNTER_APPROXIMATE_IDS]++;
+		}
+	}
+}
+
+// The id of the closest fiducial tracked in the previous frame, if the candidate is within its size
+int FiducialFinder::nearestTrackedFiducial(const FiducialX &fiducial) {
+	int nearestId = INVALID_FIDUCIAL_ID;
+	float nearestDistance = std::numeric_limits<float>::max();
+	for (int i = 0; i < MAX_FIDUCIALS; i++) {
+		TrackedFiducial &trackedFid = trackedFiducials[i];
+		if (trackedFid.isTracked) {
+			float dx = fiducial.x - trackedFid.x * fsize.width;
+			float dy = fiducial.y - trackedFid.y * fsize.height;
+			float distance = dx * dx + dy * dy;
+			if (distance <= fiducialSizes[i] * fiducialSizes[i] && distance < nearestDistance) {
+				nearestId = i;
+				nearestDistance = distance;
+			}
+		}
+	}
+	return nearestId;
+}
+
+int FiducialFinder::detectInWindows(const cv::Mat &frame, const cv::Mat &grayscale, float scale) {
+	int num = 0;
+	for (int i = 0; i < MAX_FIDUCIALS; i++) {
+		TrackedFiducial &trackedFid = trackedFiducials[i];
+		if (!trackedFid.isTracked) {
+			continue;
+		}
+
+		cv::Rect window = searchWindow(frame, scale,
+			cv::Point2f(trackedFid.x * frame.cols, trackedFid.y * frame.rows), fiducialSizes[i] * WINDOW_FACTOR);
+		num += detect(cv::Mat(frame, window), windowOf(grayscale, frame, window),
+			cv::Point2f(window.x * scale, window.y * scale), scale, rawFiducials + num, MAX_FIDUCIALS);
+	}
+	framesSinceSearch++;
+	return num;
+}
+
+int FiducialFinder::detectPyramid(const cv::Mat &frame, const cv::Mat &grayscale, float scale) {
+	// Find candidates in the downsampled image, where a pixel is white if most of its source pixels are white
+	cv::Size coarseSize(frame.cols / pyramidFactor, frame.rows / pyramidFactor);
+	cv::resize(frame, pyramidMat, coarseSize, 0, 0, cv::INTER_AREA);
+	cv::threshold(pyramidMat, pyramidMat, 127, 255, cv::THRESH_BINARY);
+	int coarseNum = detectFrame(pyramidMat, cv::Mat(), (float) fsize.width / coarseSize.width, coarseFiducials,
+		MAX_RAW_FIDUCIALS);
+
+	// Add the fiducials tracked in the previous frame, in case they are too small for the downsampled image
+	for (int i = 0; i < MAX_FIDUCIALS && coarseNum < MAX_RAW_FIDUCIALS; i++) {
+		if (trackedFiducials[i].isTracked) {
+			FiducialX &candidate = coarseFiducials[coarseNum++];
+			candidate.x = trackedFiducials[i].x * fsize.width;
+			candidate.y = trackedFiducials[i].y * fsize.height;
+			candidate.root_size = fiducialSizes[i];
+		}
+	}
+
+	// Locate the fiducials in full resolution windows around the candidates
+	cv::Rect windows[MAX_RAW_FIDUCIALS];
+	int windowCount = 0;
+	int num = 0;
+	for (int i = 0; i < coarseNum && num + MAX_FIDUCIALS <= MAX_RAW_FIDUCIALS; i++) {
+		FiducialX &candidate = coarseFiducials[i];
+		cv::Point2f center(candidate.x / scale, candidate.y / scale);
+		bool covered = false;
+		for (int j = 0; j < windowCount && !covered; j++) {
+			covered = windows[j].contains(cv::Point((int) center.x, (int) center.y));
+		}
+		if (covered) {
+			continue;
+		}
+
+		cv::Rect window = searchWindow(frame, scale, center, candidate.root_size * REFINE_FACTOR);
+		windows[windowCount++] = window;
+		num += detect(cv::Mat(frame, window), windowOf(grayscale, frame, window),
+			cv::Point2f(window.x * scale, window.y * scale), scale, rawFiducials + num, MAX_FIDUCIALS);
+	}
+	return num;
+}
+
+// A square window around the given position (in frame pixels) with at least the given side length
+// (in pixels of the full frame), moved inside the frame if necessary
+cv::Rect FiducialFinder::searchWindow(const cv::Mat &frame, float scale, cv::Point2f center, float size) {
+	int side = quantizedSide((int) (size / scale) + 1, std::min(frame.cols, frame.rows));
+	int left = (int) center.x - side / 2;
+	int top = (int) center.y - side / 2;
+	left = std::max(0, std::min(left, frame.cols - side));
+	top = std::max(0, std::min(top, frame.rows - side));
+	return cv::Rect(left, top, side, side);
+}
+
+int FiducialFinder::detectChanges(const cv::Mat &frame, const cv::Mat &grayscale, float scale) {
+	bool full = previousFrame.size() != frame.size() || ++framesSinceFullSearch >= FULL_SEARCH_INTERVAL;
+	cv::Rect changed[MAX_CHANGE_AREAS];
+	cv::Rect windows[MAX_CHANGE_AREAS];
+	int areaCount = 0;
+	if (!full) {
+		// The windows must contain every fiducial that overlaps the changed tiles
+		float largest = *std::max_element(fiducialSizes, fiducialSizes + MAX_FIDUCIALS);
+		int margin = std::max(MIN_CHANGE_MARGIN, (int) (largest / scale) + 1);
+		areaCount = changedAreas(frame, margin, changed);
+		if (areaCount == 0) {
+			std::copy(previousFiducials, previousFiducials + previousCount, rawFiducials);
+			return previousCount;
+		}
+
+		// Each area of changed tiles is searched in a window of its own
+		full = areaCount < 0;
+		int windowArea = 0;
+		for (int i = 0; i < areaCount && !full; i++) {
+			int width = quantizedSide(changed[i].width + 2 * margin, frame.cols);
+			int height = quantizedSide(changed[i].height + 2 * margin, frame.rows);
+			int left = std::max(0, std::min(changed[i].x + changed[i].width / 2 - width / 2, frame.cols - width));
+			int top = std::max(0, std::min(changed[i].y + changed[i].height / 2 - height / 2, frame.rows - height));
+			windows[i] = cv::Rect(left, top, width, height);
+			windowArea += windows[i].area();
+		}
+		full = full || 2 * windowArea > frame.cols * frame.rows;
+	}
+
+	int num = 0;
+	if (full) {
+		num = detectFrame(frame, grayscale, scale, rawFiducials, MAX_FIDUCIALS);
+		framesSinceFullSearch = 0;
+	} else {
+		// Keep the fiducials in unchanged tiles and add those found around the changed tiles
+		for (int i = 0; i < previousCount; i++) {
+			bool unchanged = true;
+			for (int j = 0; j < areaCount && unchanged; j++) {
+				unchanged = !overlaps(previousFiducials[i], changed[j], scale);
+			}
+			if (unchanged) {
+				rawFiducials[num++] = previousFiducials[i];
+			}
+		}
+		for (int i = 0; i < areaCount && num < MAX_RAW_FIDUCIALS; i++) {
+			FiducialX *found = rawFiducials + num;
+			int foundCount = detect(cv::Mat(frame, windows[i]), windowOf(grayscale, frame, windows[i]),
+				cv::Point2f(windows[i].x * scale, windows[i].y * scale), scale, found,
+				std::min(MAX_FIDUCIALS, MAX_RAW_FIDUCIALS - num));
+			for (int j = 0; j < foundCount; j++) {
+				if (overlaps(found[j], changed[i], scale)) {
+					rawFiducials[num++] = found[j];
+				}
+			}
+		}
+	}
+
+	frame.copyTo(previousFrame);
+	std::copy(rawFiducials, rawFiducials + num, previousFiducials);
+	previousCount = num;
+	return num;
+}
+
+// Mark the tiles in which the frame differs from the previous frame and group touching tiles into
+// areas, in pixels of the frame. Areas closer than twice the margin are merged, so that their search
+// windows do not overlap. Returns the number of areas, 0 if the frames are equal and -1 if a full
+// search is cheaper: more than half of the tiles or more than MAX_CHANGE_AREAS areas changed.
+int FiducialFinder::changedAreas(const cv::Mat &frame, int margin, cv::Rect *areas) {
+	int columns = (frame.cols + CHANGE_TILE_SIZE - 1) / CHANGE_TILE_SIZE;
+	int rows = (frame.rows + CHANGE_TILE_SIZE - 1) / CHANGE_TILE_SIZE;
+	dirtyTiles.assign(columns * rows, 0);
+	int dirtyCount = 0;
+	for (int y = 0; y < frame.rows; y++) {
+		const unsigned char *row = frame.ptr(y);
+		const unsigned char *previousRow = previousFrame.ptr(y);
+		if (memcmp(row, previousRow, frame.cols) == 0) {
+			continue;
+		}
+		unsigned char *dirtyRow = &dirtyTiles[(y / CHANGE_TILE_SIZE) * columns];
+		for (int column = 0; column < columns; column++) {
+			int left = column * CHANGE_TILE_SIZE;
+			if (!dirtyRow[column] && memcmp(row + left, previousRow + left,
+					std::min(CHANGE_TILE_SIZE, frame.cols - left)) != 0) {
+				dirtyRow[column] = 1;
+				dirtyCount++;
+			}
+		}
+	}
+	if (dirtyCount == 0) {
+		return 0;
+	}
+	if (2 * dirtyCount > columns * rows) {
+		return -1;
+	}
+
+	// Collect the bounding boxes of touching dirty tiles, marking collected tiles with 2
+	tileAreas.clear();
+	for (int i = 0; i < columns * rows; i++) {
+		if (dirtyTiles[i] != 1) {
+			continue;
+		}
+		int left = columns, right = 0, top = rows, bottom = 0;
+		dirtyTiles[i] = 2;
+		tileStack.clear();
+		tileStack.push_back(i);
+		while (!tileStack.empty()) {
+			int tile = tileStack.back();
+			tileStack.pop_back();
+			int column = tile % columns;
+			int row = tile / columns;
+			left = std::min(left, column);
+			right = std::max(right, column + 1);
+			top = std::min(top, row);
+			bottom = std::max(bottom, row + 1);
+			for (int y = std::max(0, row - 1); y <= std::min(row + 1, rows - 1); y++) {
+				for (int x = std::max(0, column - 1); x <= std::min(column + 1, columns - 1); x++) {
+					if (dirtyTiles[y * columns + x] == 1) {
+						dirtyTiles[y * columns + x] = 2;
+						tileStack.push_back(y * columns + x);
+					}
+				}
+			}
+		}
+		if (tileAreas.size() >= 4 * MAX_CHANGE_AREAS) {
+			return -1;
+		}
+		left *= CHANGE_TILE_SIZE;
+		top *= CHANGE_TILE_SIZE;
+		tileAreas.push_back(cv::Rect(left, top, std::min(frame.cols, right * CHANGE_TILE_SIZE) - left,
+			std::min(frame.rows, bottom * CHANGE_TILE_SIZE) - top));
+	}
+
+	// Merge areas whose margins overlap until no such pair is left
+	bool merged = true;
+	while (merged) {
+		merged = false;
+		for (size_t i = 0; i < tileAreas.size() && !merged; i++) {
+			cv::Rect extended(tileAreas[i].x - 2 * margin, tileAreas[i].y - 2 * margin,
+				tileAreas[i].width + 4 * margin, tileAreas[i].height + 4 * margin);
+			for (size_t j = i + 1; j < tileAreas.size() && !merged; j++) {
+				if ((extended & tileAreas[j]).area() > 0) {
+					tileAreas[i] = tileAreas[i] | tileAreas[j];
+					tileAreas.erase(tileAreas.begin() + j);
+					merged = true;
+				}
+			}
+		}
+	}
+	if ((int) tileAreas.size() > MAX_CHANGE_AREAS) {
+		return -1;
+	}
+	std::copy(tileAreas.begin(), tileAreas.end(), areas);
+	return (int) tileAreas.size();
+}
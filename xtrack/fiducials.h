@@ -12,9 +12,17 @@
 
 #include "stdafx.h"
 #include "fidtrackX.h"
+#include "fidtrack120.h"
 #include "segment.h"
+#include "diagnostics.h"
+#include "workerpool.h"
+#include "blobs.h"
 
 #define MAX_FIDUCIALS 4
+// The maximal number of fiducial candidates collected in one frame
+#define MAX_RAW_FIDUCIALS (MAX_FIDUCIALS * (MAX_FIDUCIALS + 1))
+// The maximal number of regions of both colours collected per frame when searching blobs
+#define MAX_BLOB_REGIONS (4 * MAX_BLOBS)
 
 class TrackedFiducial {
 public:
@@ -40,23 +48,184 @@ public:
 	float aacc;
 };
 
+// The recognizers of libfidtrack that find the fiducials in the segmented image
+enum FiducialEngine {
+	// Trees of nested regions, matched against the known trees (fidtrackX)
+	ENGINE_FIDTRACKX,
+	// The 120 fiducials of six symbols in two rows, recognized by the topology of their regions
+	// (fidtrack120). Ids are 0 to 119, positions are not refined with sub-pixel accuracy.
+	ENGINE_FIDTRACK120
+};
+
+// Segmentation and fiducial recognition for images of a fixed size
+class FiducialDetector {
+public:
+	FiducialDetector(cv::Size &size, TreeIdMap *treeidmap);
+	~FiducialDetector();
+
+	// Find fiducial candidates in the given image, which must have the size of this detector.
+	// If a grayscale image of the same size is given, the positions of fiducials with a valid
+	// id are refined with sub-pixel accuracy. The statistics are added to the diagnostics.
+	// The positions of the candidates are computed by the workers, if given.
+	int findCandidates(const cv::Mat &image, const cv::Mat &grayscale, FiducialX *fiducials, int maxCount,
+		TrackingDiagnostics &diagnostics, WorkerPool *workers);
+	// Find the regions of the image segmented by the last call of findCandidates whose bounding
+	// box is larger than minSize and smaller than maxSize pixels in both directions.
+	int findRegions(RegionX *regions, int maxCount, int minSize, int maxSize);
+	// Fill the given map of size width * height with the identity warp and use it instead of the
+	// current pixel map, which is deleted.
+	void setPixelMap(ShortPoint *map);
+
+	cv::Size size;
+	Segmenter segmenter;
+	FidtrackerX fidtrackerx;
+	ShortPoint *dmap;
+	// The morphological filters applied while thresholding, see packed_threshold_filtered
+	int morphology;
+	// The recognizer of the fiducials
+	FiducialEngine engine;
+
+private:
+	// The bit-packed contrast image passed to the segmenter
+	std::vector<PackedWord> packed;
+	// The rows of the morphological filters in flight while thresholding
+	std::vector<PackedWord> filterRows;
+	PartialSegmentTopology topology;
+	std::vector<Fiducial120> fiducials120;
+
+	int findCandidates120(FiducialX *fiducials, int maxCount, FidtrackerXStats &stats);
+};
+
 class FiducialFinder {
 public:
 	// Array of tracked fiducials: the array index corresponds to the fiducial id
 	TrackedFiducial trackedFiducials[MAX_FIDUCIALS];
 
-	FiducialFinder(cv::Size &fsize);
+	// The tree file contains the fiducial trees in text or binary form, the default trees are used
+	// if it is empty.
+	FiducialFinder(cv::Size &fsize, const std::string &treeFile);
 	~FiducialFinder();
 
 	// Find fiducials and store them in the 'fiducials' array. The return value
-	// is the number of actually found fiducials.
-	int findFiducials(cv::InputArray, double timestamp);
+	// is the number of tracked fiducials, i.e. of distinct ids below MAX_FIDUCIALS; several
+	// candidates with the same id count once. The input may be smaller than the
+	// frame size given to the constructor, e.g. when it has been downscaled. If the grayscale
+	// image from which the input has been thresholded is given, the fiducial positions are
+	// refined with sub-pixel accuracy.
+	int findFiducials(cv::InputArray, double timestamp, const cv::Mat &grayscale = cv::Mat());
+	// Search only in windows around the fiducials tracked in the previous frame. The
+	// whole frame is still searched regularly in order to find new fiducials.
+	void setWindowTracking(bool enabled);
+	// Search candidates in a copy of the frame that is downsampled by the given factor (1, 2 or 4)
+	// and locate the fiducials only in full resolution windows around these candidates.
+	void setPyramidFactor(int factor);
+	// Compare each frame with the last searched frame in tiles, keep the fiducials found in
+	// unchanged tiles and search fiducials only in a window around the changed tiles. Has no
+	// effect with a pyramid factor larger than 1.
+	void setIncremental(bool enabled);
+	// Traverse up to this number of fragmented regions per image in a deferred pass, so that
+	// fiducials with a saturated region in their root are still recognized (0 to disable).
+	void setDeferredRegions(int maxRegions);
+	// Fold closed regions whose bounding box covers at most this number of pixels into their
+	// surrounding region while segmenting, so that pixel noise is ignored (0 to disable).
+	void setNoiseGate(int maxArea);
+	// Open and/or close the contrast image with a 3x3 square before segmenting it, a combination
+	// of PACKED_OPEN_FILTER and PACKED_CLOSE_FILTER (0 to disable).
+	void setMorphology(int filter);
+	// Search only the fiducials with the given ids, e.g. '0,1,2,3' or '0-3', and stop as soon as
+	// each of them has been found. Candidates with other valid ids are skipped, candidates without
+	// valid id are still returned. Empty for all ids.
+	void setExpectedIds(const std::string &ids);
+	// Compute the positions of the fiducial candidates on the given number of additional threads,
+	// which pays off for scenes with many fiducials or cluttered backgrounds (0 to disable). The
+	// threads are pinned to consecutive cores from firstCore on (unless it is negative) and run with
+	// the given real-time priority (unless it is 0), see configureCurrentThread.
+	void setWorkerThreads(int threads, int firstCore, int priority);
+	// Assign candidates without valid id near a fiducial tracked in the previous frame the id of the
+	// closest known tree, if its depth string differs in at most maxDistance edits (0 to disable).
+	// The tracked fiducial is preferred among equally close trees. At most 'budget' trees are
+	// compared per frame.
+	void setApproximateMatching(int maxDistance, int budget);
+	// Recognize the fiducials with the given engine. Expected ids, deferred regions and approximate
+	// matching only apply to ENGINE_FIDTRACKX.
+	void setEngine(FiducialEngine engine);
+	// Also track the regions of the given colour (255 for white, 0 for black) whose bounding box
+	// is larger than minSize and smaller than maxSize pixels of the full frame as blobs. Blobs that
+	// moved at most maxDistance pixels between two frames keep their session. The blobs are found
+	// in the same segmentation as the fiducials, but only when the whole frame is searched.
+	void setBlobTracking(bool enabled, int minSize, int maxSize, int colour, int maxDistance);
+	// The blobs tracked in the last frame in which the whole frame has been searched.
+	const std::vector<TrackedBlob> &trackedBlobs();
+	// The number of fiducial candidates found in the last frame, including those without valid id.
+	int lastCandidateCount();
+	// The number of fiducial candidates with a valid id found in the last frame.
+	int lastValidCount();
+	// The segmentation and recognition statistics of the last frame.
+	const TrackingDiagnostics &lastDiagnostics();
+	// Touch the large buffers used for tracking so that they are in memory before the first frame.
+	void prefaultBuffers(bool hugePages, bool lock);
 
 private:
-	FiducialX rawFiducials[MAX_FIDUCIALS];
-	Segmenter segmenter;
+	FiducialX rawFiducials[MAX_RAW_FIDUCIALS];
+	FiducialX coarseFiducials[MAX_RAW_FIDUCIALS];
 	TreeIdMap treeidmap;
-	FidtrackerX fidtrackerx;
-	ShortPoint *dmap;
+	// Detectors for the image sizes used recently, the first one has the full frame size and the
+	// others are in the order of their last use
+	std::vector<FiducialDetector *> detectors;
 	cv::Size fsize;
+	int candidateCount;
+	int validCount;
+	TrackingDiagnostics diagnostics;
+	bool windowTracking;
+	int framesSinceSearch;
+	int pyramidFactor;
+	cv::Mat pyramidMat;
+	bool incremental;
+	int framesSinceFullSearch;
+	int deferredRegions;
+	int noiseGate;
+	int morphology;
+	FiducialEngine engine;
+	// The ids searched by each detector, all ids if empty
+	std::vector<int> expectedIds;
+	// Computes the statistics of the candidates in parallel, NULL to compute them serially
+	WorkerPool *workers;
+	int approximateDistance;
+	int approximateBudget;
+	// The number of trees that may still be compared in the current frame
+	int remainingBudget;
+	bool blobTracking;
+	int blobMinSize;
+	int blobMaxSize;
+	int blobColour;
+	BlobTracker blobTracker;
+	RegionX blobRegions[MAX_BLOB_REGIONS];
+	Blob blobs[MAX_BLOBS];
+	// The number of blobs found in the current frame, -1 if the whole frame has not been searched
+	int blobCount;
+	// The last frame searched in incremental mode and the fiducials found in it
+	cv::Mat previousFrame;
+	FiducialX previousFiducials[MAX_RAW_FIDUCIALS];
+	int previousCount;
+	// The tiles in which the frame differs from the previous frame, and the areas of touching tiles
+	std::vector<unsigned char> dirtyTiles;
+	std::vector<int> tileStack;
+	std::vector<cv::Rect> tileAreas;
+	// The size of the tracked fiducials in pixels of the full frame
+	float fiducialSizes[MAX_FIDUCIALS];
+
+	FiducialDetector *getDetector(cv::Size size);
+	int detect(const cv::Mat &image, const cv::Mat &grayscale, cv::Point2f offset, float scale,
+		FiducialX *fiducials, int maxCount);
+	int detectFrame(const cv::Mat &image, const cv::Mat &grayscale, float scale, FiducialX *fiducials,
+		int maxCount);
+	int detectInWindows(const cv::Mat &frame, const cv::Mat &grayscale, float scale);
+	int detectPyramid(const cv::Mat &frame, const cv::Mat &grayscale, float scale);
+	int detectChanges(const cv::Mat &frame, const cv::Mat &grayscale, float scale);
+	void setExpectedIds(FiducialDetector *detector);
+	void matchApproximately(FiducialDetector *detector, FiducialX *fiducials, int num);
+	int nearestTrackedFiducial(const FiducialX &fiducial);
+	void findBlobs(FiducialDetector *detector, float scale, const FiducialX *fiducials, int num);
+	int changedAreas(const cv::Mat &frame, int margin, cv::Rect *areas);
+	cv::Rect searchWindow(const cv::Mat &frame, float scale, cv::Point2f center, float size);
 };
@@ -0,0 +1,98 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Reducing the processing quality when frames take longer than the frame time
+
+#include <algorithm>
+#include "governor.h"
+
+// The weight of the last frame in the average processing time
+static const double SMOOTHING_FACTOR = 0.2;
+// The level is raised when the average time exceeds this part of the frame time ...
+static const double OVERLOAD_RATIO = 0.95;
+// ... for this number of frames
+static const int OVERLOAD_FRAMES = 10;
+// The level is lowered when the average time stays below this part of the frame time ...
+static const double UNDERLOAD_RATIO = 0.6;
+// ... for a number of frames that starts with this value and is doubled whenever the load
+// rises again soon after lowering the level, up to the maximum
+static const int MIN_RECOVERY_FRAMES = 60;
+static const int MAX_RECOVERY_FRAMES = 3840;
+
+LoadGovernor::LoadGovernor(int frameTime) {
+	this->frameTime = frameTime;
+	this->averageTime = 0;
+	this->currentLevel = LOAD_NORMAL;
+	this->overloadFrames = 0;
+	this->underloadFrames = 0;
+	this->recoveryFrames = MIN_RECOVERY_FRAMES;
+	this->recovered = false;
+	this->framesSinceRecovery = 0;
+}
+
+bool LoadGovernor::update(StageTimer &stageTimer) {
+	double time = 0;
+	for (int stage = 0; stage < STAGE_COUNT; stage++) {
+		time += stageTimer.lastTime((ProcessingStage) stage);
+	}
+	averageTime += SMOOTHING_FACTOR * (time - averageTime);
+	if (framesSinceRecovery <= 4 * MAX_RECOVERY_FRAMES) {
+		framesSinceRecovery++;
+	}
+
+	if (averageTime > OVERLOAD_RATIO * frameTime) {
+		underloadFrames = 0;
+		if (++overloadFrames >= OVERLOAD_FRAMES && currentLevel < LOAD_LEVEL_COUNT - 1) {
+			// Falling back soon after a recovery means that the lower level cannot be sustained
+			if (recovered && framesSinceRecovery < 2 * recoveryFrames) {
+				recoveryFrames = std::min(2 * recoveryFrames, MAX_RECOVERY_FRAMES);
+			}
+			recovered = false;
+			currentLevel = (LoadLevel) (currentLevel + 1);
+			overloadFrames = 0;
+			return true;
+		}
+	} else if (averageTime < UNDERLOAD_RATIO * frameTime) {
+		overloadFrames = 0;
+		if (++underloadFrames >= recoveryFrames && currentLevel > LOAD_NORMAL) {
+			currentLevel = (LoadLevel) (currentLevel - 1);
+			underloadFrames = 0;
+			recovered = true;
+			framesSinceRecovery = 0;
+			return true;
+		}
+		if (framesSinceRecovery > 4 * MAX_RECOVERY_FRAMES) {
+			recoveryFrames = MIN_RECOVERY_FRAMES;
+		}
+	} else {
+		overloadFrames = 0;
+		underloadFrames = 0;
+	}
+	return false;
+}
+
+LoadLevel LoadGovernor::level() {
+	return currentLevel;
+}
+
+const char *LoadGovernor::levelName(LoadLevel level) {
+	switch (level) {
+	case LOAD_NORMAL:
+		return "full quality";
+	case LOAD_REDUCED_PREVIEW:
+		return "reduced preview rate";
+	case LOAD_NO_CONTRAST_WINDOW:
+		return "contrast window disabled";
+	case LOAD_WINDOW_TRACKING:
+		return "tracking around known fiducials";
+	case LOAD_DOWNSCALED:
+		return "downscaled input";
+	default:
+		return "unknown";
+	}
+}
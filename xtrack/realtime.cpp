@@ -0,0 +1,68 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Real-time scheduling and memory locking with a platform dependent implementation.
+// All functions print what has actually been granted by the operating system.
+
+#include <windows.h>
+#include "realtime.h"
+
+void configureCurrentThread(const std::string &name, int core, int priority) {
+	if (core >= 0) {
+		if (SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR) 1 << core) != 0) {
+			std::cout << name << " thread pinned to core " << core << "\n";
+		} else {
+			std::cerr << name << " thread cannot be pinned to core " << core << " (error " << GetLastError() << ")\n";
+		}
+	}
+	if (priority > 0) {
+		// Windows has no numbered real-time priorities: use the highest priority class that is granted
+		if (!SetPriorityClass(GetCurrentProcess(), REALTIME_PRIORITY_CLASS)) {
+			SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
+		}
+		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+		DWORD priorityClass = GetPriorityClass(GetCurrentProcess());
+		std::cout << name << " thread runs with time critical priority in the "
+			<< (priorityClass == REALTIME_PRIORITY_CLASS ? "real-time"
+				: priorityClass == HIGH_PRIORITY_CLASS ? "high" : "normal")
+			<< " priority class\n";
+	}
+}
+
+bool lockProcessMemory() {
+	// There is no equivalent to mlockall: only the buffers given to 'prefaultBuffer' are locked
+	std::cout << "Memory locking is restricted to the tracking buffers on this system\n";
+	return false;
+}
+
+void prefaultBuffer(void *buffer, size_t size, bool hugePages, bool lock) {
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	size_t pageSize = systemInfo.dwPageSize;
+	volatile unsigned char *bytes = (volatile unsigned char *) buffer;
+	for (size_t offset = 0; offset < size; offset += pageSize) {
+		// Buffers may already hold data, so each page is faulted in without changing it
+		bytes[offset] = bytes[offset];
+	}
+	std::cout << "Prefaulted " << (size >> 10) << " KB of tracking buffers";
+	if (hugePages) {
+		// Large pages can only be requested when allocating memory
+		std::cout << ", huge pages are not supported";
+	}
+	if (lock) {
+		SIZE_T minimumSize, maximumSize;
+		GetProcessWorkingSetSize(GetCurrentProcess(), &minimumSize, &maximumSize);
+		SetProcessWorkingSetSize(GetCurrentProcess(), minimumSize + size, maximumSize + size);
+		if (VirtualLock(buffer, size)) {
+			std::cout << ", locked";
+		} else {
+			std::cout << ", cannot be locked (error " << GetLastError() << ")";
+		}
+	}
+	std::cout << "\n";
+}
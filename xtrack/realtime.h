@@ -0,0 +1,26 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Real-time scheduling and memory locking with a platform dependent implementation.
+// All functions print what has actually been granted by the operating system.
+
+#pragma once
+
+#include "stdafx.h"
+
+// Pin the calling thread to the given processor core, unless the core is negative, and
+// request real-time scheduling with the given priority, unless the priority is 0.
+void configureCurrentThread(const std::string &name, int core, int priority);
+
+// Lock all pages of the process into memory, including pages allocated in the future.
+bool lockProcessMemory();
+
+// Touch every page of the given buffer so that no page faults occur when it is first used
+// during processing. If requested, the buffer is backed by huge pages where possible, and
+// it is locked into memory on systems where this is not done for the whole process.
+void prefaultBuffer(void *buffer, size_t size, bool hugePages, bool lock);
@@ -0,0 +1,454 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Lossless recording and replay of contrast images using run-length encoding
+//
+// File layout (all numbers little endian):
+//   header:  "XTRL", uint32 version, uint32 width, uint32 height
+//   frames:  uint32 payload length, float64 timestamp, payload
+//   index:   for each frame: uint64 offset, float64 timestamp
+//   footer:  uint64 index offset, uint32 frame count, "XTRI"
+// The payload contains the run lengths of all rows as unsigned LEB128 numbers.
+// The index and footer are missing if the recording was not stopped properly;
+// in that case the frames are found by scanning the file.
+
+#include <climits>
+#include <cstring>
+#include "rlerecord.h"
+
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#else
+#define fseek64 fseeko
+#define ftell64 ftello
+#endif
+
+const std::string RLE_FILE_EXT = ".rle";
+
+static const char HEADER_MAGIC[] = "XTRL";
+static const char FOOTER_MAGIC[] = "XTRI";
+static const unsigned int FORMAT_VERSION = 1;
+static const int HEADER_SIZE = 16;
+static const int FRAME_HEADER_SIZE = 12;
+static const int FOOTER_SIZE = 16;
+static const int INDEX_ENTRY_SIZE = 16;
+// Frames are dropped if the background thread cannot keep up with writing
+static const size_t MAX_QUEUED_FRAMES = 100;
+// Recordings with larger frames are rejected as corrupt
+static const int MAX_FRAME_SIDE = 16384;
+
+static void putUInt(unsigned char *dest, unsigned long long value, int bytes) {
+	for (int i = 0; i < bytes; i++) {
+		dest[i] = (unsigned char) (value >> (8 * i));
+	}
+}
+
+static unsigned long long getUInt(const unsigned char *src, int bytes) {
+	unsigned long long value = 0;
+	for (int i = 0; i < bytes; i++) {
+		value |= (unsigned long long) src[i] << (8 * i);
+	}
+	return value;
+}
+
+static void putDouble(unsigned char *dest, double value) {
+	unsigned long long bits;
+	memcpy(&bits, &value, sizeof(bits));
+	putUInt(dest, bits, 8);
+}
+
+static double getDouble(const unsigned char *src) {
+	unsigned long long bits = getUInt(src, 8);
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static void encodeRow(const unsigned char *row, int width, std::vector<unsigned char> &output) {
+	bool white = false;
+	int x = 0;
+	while (x < width) {
+		int start = x;
+		if (white) {
+			while (x < width && row[x] != 0) {
+				x++;
+			}
+		} else {
+			while (x < width && row[x] == 0) {
+				x++;
+			}
+		}
+		unsigned int length = x - start;
+		while (length >= 0x80) {
+			output.push_back((unsigned char) (length | 0x80));
+			length >>= 7;
+		}
+		output.push_back((unsigned char) length);
+		white = !white;
+	}
+}
+
+static bool decodeFrame(const std::vector<unsigned char> &payload, cv::Mat &frame) {
+	size_t pos = 0;
+	for (int y = 0; y < frame.rows; y++) {
+		unsigned char *row = frame.ptr(y);
+		unsigned char colour = 0;
+		int x = 0;
+		while (x < frame.cols) {
+			unsigned int length = 0;
+			int shift = 0;
+			unsigned char byte;
+			do {
+				if (pos >= payload.size()) {
+					return false;
+				}
+				byte = payload[pos++];
+				length |= (unsigned int) (byte & 0x7F) << shift;
+				shift += 7;
+			} while ((byte & 0x80) != 0);
+			if (length > (unsigned int) (frame.cols - x)) {
+				return false;
+			}
+			memset(row + x, colour, length);
+			x += length;
+			colour = 255 - colour;
+		}
+	}
+	return pos == payload.size();
+}
+
+// The payload length of a frame at most: each row has at most width + 1 runs, and the length of
+// a run up to MAX_FRAME_SIDE takes at most three bytes
+static unsigned long long maxPayloadLength(cv::Size fsize) {
+	return (unsigned long long) (fsize.width + 1) * 3 * fsize.height;
+}
+
+bool isRleFileName(const std::string &fileName) {
+	return fileName.length() > RLE_FILE_EXT.length()
+		&& fileName.compare(fileName.length() - RLE_FILE_EXT.length(), RLE_FILE_EXT.length(), RLE_FILE_EXT) == 0;
+}
+
+
+ThresholdRecorder::ThresholdRecorder() {
+	this->file = NULL;
+	this->indexOffset = 0;
+	this->stopRequested = false;
+	this->droppedFrames = 0;
+	this->writeFailed = false;
+}
+
+ThresholdRecorder::~ThresholdRecorder() {
+	stopRecording();
+	while (!freeBuffers.empty()) {
+		delete freeBuffers.back();
+		freeBuffers.pop_back();
+	}
+}
+
+bool ThresholdRecorder::startRecording(const std::string &fileName, cv::Size &fsize) {
+	if (file != NULL) {
+		return false;
+	}
+	file = fopen(fileName.c_str(), "wb");
+	if (file == NULL) {
+		std::cerr << "Could not open output file " << fileName << " for contrast image recording.\n";
+		return false;
+	}
+	unsigned char header[HEADER_SIZE];
+	memcpy(header, HEADER_MAGIC, 4);
+	putUInt(header + 4, FORMAT_VERSION, 4);
+	putUInt(header + 8, fsize.width, 4);
+	putUInt(header + 12, fsize.height, 4);
+	if (fwrite(header, 1, HEADER_SIZE, file) != HEADER_SIZE || fflush(file) != 0) {
+		std::cerr << "Could not write to output file " << fileName << " for contrast image recording.\n";
+		fclose(file);
+		file = NULL;
+		return false;
+	}
+
+	this->fsize = fsize;
+	index.clear();
+	stopRequested = false;
+	droppedFrames = 0;
+	writeFailed = false;
+	if (!start()) {
+		fclose(file);
+		file = NULL;
+		return false;
+	}
+	std::cout << "Recording contrast images to file " << fileName << "\n";
+	return true;
+}
+
+void ThresholdRecorder::recordFrame(cv::InputArray input, double timestamp) {
+	cv::Mat frameMat = input.getMat();
+	if (file == NULL) {
+		return;
+	}
+
+	std::vector<unsigned char> *buffer;
+	{
+		MutexLock lock(queueMutex);
+		// Frames downscaled by the load governor do not fit into the file
+		if (writeFailed || frameMat.size() != fsize || queue.size() >= MAX_QUEUED_FRAMES) {
+			droppedFrames++;
+			return;
+		}
+		if (freeBuffers.empty()) {
+			buffer = new std::vector<unsigned char>();
+		} else {
+			buffer = freeBuffers.back();
+			freeBuffers.pop_back();
+		}
+	}
+
+	buffer->resize(FRAME_HEADER_SIZE);
+	for (int y = 0; y < frameMat.rows; y++) {
+		encodeRow(frameMat.ptr(y), frameMat.cols, *buffer);
+	}
+	putUInt(&(*buffer)[0], buffer->size() - FRAME_HEADER_SIZE, 4);
+	putDouble(&(*buffer)[4], timestamp);
+
+	MutexLock lock(queueMutex);
+	queue.push_back(buffer);
+	queueCondition.notifyAll();
+}
+
+void ThresholdRecorder::stopRecording() {
+	if (file == NULL) {
+		return;
+	}
+	{
+		MutexLock lock(queueMutex);
+		stopRequested = true;
+		queueCondition.notifyAll();
+	}
+	join();
+
+	// Append the frame index and the footer. Without them the frames are found by scanning
+	// the file, so they are left out after a failed write.
+	if (!writeFailed) {
+		unsigned char entry[INDEX_ENTRY_SIZE];
+		for (size_t i = 0; i < index.size() && !writeFailed; i++) {
+			putUInt(entry, index[i].offset, 8);
+			putDouble(entry + 8, index[i].timestamp);
+			writeFailed = fwrite(entry, 1, INDEX_ENTRY_SIZE, file) != INDEX_ENTRY_SIZE;
+		}
+		unsigned char footer[FOOTER_SIZE];
+		putUInt(footer, indexOffset, 8);
+		putUInt(footer + 8, index.size(), 4);
+		memcpy(footer + 12, FOOTER_MAGIC, 4);
+		if (writeFailed || fwrite(footer, 1, FOOTER_SIZE, file) != FOOTER_SIZE) {
+			std::cerr << "Could not write the index of the contrast image recording.\n";
+		}
+	}
+	if (fclose(file) != 0) {
+		std::cerr << "Could not write the end of the contrast image recording.\n";
+	}
+	file = NULL;
+
+	std::cout << "Stopped contrast image recording (" << index.size() << " frames";
+	if (droppedFrames > 0) {
+		std::cout << ", " << droppedFrames << " dropped";
+	}
+	std::cout << ").\n";
+}
+
+bool ThresholdRecorder::isRecording() {
+	return file != NULL;
+}
+
+void ThresholdRecorder::run() {
+	indexOffset = HEADER_SIZE;
+	while (true) {
+		std::vector<unsigned char> *buffer;
+		{
+			MutexLock lock(queueMutex);
+			while (queue.empty() && !stopRequested) {
+				queueCondition.wait(queueMutex);
+			}
+			if (queue.empty()) {
+				break;
+			}
+			buffer = queue.front();
+			queue.pop_front();
+		}
+
+		// Each frame is flushed so that a failed write, e.g. on a full disk, is noticed before the frame
+		// is indexed. The remaining frames are then dropped.
+		bool written = !writeFailed && fwrite(&(*buffer)[0], 1, buffer->size(), file) == buffer->size()
+			&& fflush(file) == 0;
+		if (written) {
+			RleFrameIndexEntry entry;
+			entry.offset = indexOffset;
+			entry.timestamp = getDouble(&(*buffer)[4]);
+			index.push_back(entry);
+			indexOffset += buffer->size();
+		} else if (!writeFailed) {
+			std::cerr << "Could not write to the contrast image recording, dropping further frames.\n";
+		}
+
+		MutexLock lock(queueMutex);
+		if (!written) {
+			writeFailed = true;
+			droppedFrames++;
+		}
+		freeBuffers.push_back(buffer);
+	}
+}
+
+
+ThresholdPlayer::ThresholdPlayer() {
+	this->file = NULL;
+	this->fileSize = 0;
+	this->nextFrame = 0;
+}
+
+ThresholdPlayer::~ThresholdPlayer() {
+	close();
+}
+
+bool ThresholdPlayer::open(const std::string &fileName) {
+	close();
+	file = fopen(fileName.c_str(), "rb");
+	if (file == NULL) {
+		return false;
+	}
+	unsigned char header[HEADER_SIZE];
+	if (fread(header, 1, HEADER_SIZE, file) != HEADER_SIZE || memcmp(header, HEADER_MAGIC, 4) != 0
+			|| getUInt(header + 4, 4) != FORMAT_VERSION) {
+		std::cerr << "File " << fileName << " is not a valid contrast image recording.\n";
+		close();
+		return false;
+	}
+	unsigned long long width = getUInt(header + 8, 4);
+	unsigned long long height = getUInt(header + 12, 4);
+	if (width == 0 || width > MAX_FRAME_SIDE || height == 0 || height > MAX_FRAME_SIDE
+			|| fseek64(file, 0, SEEK_END) != 0 || (fileSize = ftell64(file)) < HEADER_SIZE) {
+		std::cerr << "File " << fileName << " is not a valid contrast image recording.\n";
+		close();
+		return false;
+	}
+	fsize = cv::Size((int) width, (int) height);
+	if (!readIndex()) {
+		std::cout << "The recording " << fileName << " has no valid index, scanning frames.\n";
+		scanFrames();
+	}
+	return seekFrame(0);
+}
+
+void ThresholdPlayer::close() {
+	if (file != NULL) {
+		fclose(file);
+		file = NULL;
+	}
+	index.clear();
+	nextFrame = 0;
+}
+
+cv::Size ThresholdPlayer::frameSize() {
+	return fsize;
+}
+
+int ThresholdPlayer::frameCount() {
+	return (int) index.size();
+}
+
+bool ThresholdPlayer::seekFrame(int frame) {
+	if (file == NULL || frame < 0 || frame > (int) index.size()) {
+		return false;
+	}
+	nextFrame = frame;
+	if (frame < (int) index.size()) {
+		return fseek64(file, index[frame].offset, SEEK_SET) == 0;
+	}
+	return true;
+}
+
+bool ThresholdPlayer::readFrame(cv::OutputArray output, double &timestamp) {
+	if (file == NULL || nextFrame >= (int) index.size()) {
+		return false;
+	}
+	unsigned char frameHeader[FRAME_HEADER_SIZE];
+	if (fread(frameHeader, 1, FRAME_HEADER_SIZE, file) != FRAME_HEADER_SIZE) {
+		return false;
+	}
+	unsigned long long payloadLength = getUInt(frameHeader, 4);
+	if (payloadLength > maxPayloadLength(fsize) || ftell64(file) + (long long) payloadLength > fileSize) {
+		std::cerr << "Frame " << nextFrame << " of the contrast image recording is corrupt.\n";
+		return false;
+	}
+	buffer.resize((size_t) payloadLength);
+	timestamp = getDouble(frameHeader + 4);
+	if (!buffer.empty() && fread(&buffer[0], 1, buffer.size(), file) != buffer.size()) {
+		return false;
+	}
+	output.create(fsize, CV_8UC1);
+	cv::Mat frameMat = output.getMat();
+	if (!decodeFrame(buffer, frameMat)) {
+		std::cerr << "Frame " << nextFrame << " of the contrast image recording is corrupt.\n";
+		return false;
+	}
+	nextFrame++;
+	return true;
+}
+
+bool ThresholdPlayer::readIndex() {
+	unsigned char footer[FOOTER_SIZE];
+	if (fseek64(file, -FOOTER_SIZE, SEEK_END) != 0
+			|| fread(footer, 1, FOOTER_SIZE, file) != FOOTER_SIZE
+			|| memcmp(footer + 12, FOOTER_MAGIC, 4) != 0) {
+		return false;
+	}
+	// The index must fill the file between the frames and the footer, and each frame must start
+	// with a complete frame header before the index
+	unsigned long long indexOffset = getUInt(footer, 8);
+	unsigned long long count = getUInt(footer + 8, 4);
+	if (count > INT_MAX || indexOffset < HEADER_SIZE || indexOffset > (unsigned long long) fileSize
+			|| indexOffset + count * INDEX_ENTRY_SIZE + FOOTER_SIZE != (unsigned long long) fileSize
+			|| fseek64(file, (long long) indexOffset, SEEK_SET) != 0) {
+		return false;
+	}
+	index.resize((size_t) count);
+	unsigned char entry[INDEX_ENTRY_SIZE];
+	for (size_t i = 0; i < index.size(); i++) {
+		if (fread(entry, 1, INDEX_ENTRY_SIZE, file) != INDEX_ENTRY_SIZE) {
+			index.clear();
+			return false;
+		}
+		unsigned long long offset = getUInt(entry, 8);
+		if (offset < HEADER_SIZE || offset + FRAME_HEADER_SIZE > indexOffset) {
+			index.clear();
+			return false;
+		}
+		index[i].offset = (long long) offset;
+		index[i].timestamp = getDouble(entry + 8);
+	}
+	return true;
+}
+
+void ThresholdPlayer::scanFrames() {
+	index.clear();
+	long long offset = HEADER_SIZE;
+	unsigned char frameHeader[FRAME_HEADER_SIZE];
+	while (fseek64(file, offset, SEEK_SET) == 0
+			&& fread(frameHeader, 1, FRAME_HEADER_SIZE, file) == FRAME_HEADER_SIZE) {
+		long long payloadLength = (long long) getUInt(frameHeader, 4);
+		// Stop at the last frame if it has not been written completely, or at corrupt data
+		if ((unsigned long long) payloadLength > maxPayloadLength(fsize)
+				|| offset + FRAME_HEADER_SIZE + payloadLength > fileSize) {
+			break;
+		}
+		RleFrameIndexEntry entry;
+		entry.offset = offset;
+		entry.timestamp = getDouble(frameHeader + 4);
+		index.push_back(entry);
+		offset += FRAME_HEADER_SIZE + payloadLength;
+	}
+}
@@ -0,0 +1,103 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Lossless recording and replay of contrast images using run-length encoding
+
+#pragma once
+
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+#include "stdafx.h"
+#include "threads.h"
+
+// The file extension used for run-length encoded recordings.
+extern const std::string RLE_FILE_EXT;
+
+struct RleFrameIndexEntry {
+	// The position of the frame in the file
+	long long offset;
+	// The capture timestamp of the frame in milliseconds
+	double timestamp;
+};
+
+// Records contrast images to a file. Each row is stored as a sequence of run lengths of
+// alternating black and white pixels, starting with black. The frames are encoded in the
+// calling thread and written to the file by a background thread. When the recording is
+// stopped, an index of all frames is appended to the file.
+class ThresholdRecorder : private Thread {
+public:
+	ThresholdRecorder();
+	~ThresholdRecorder();
+
+	// Start recording to the given file.
+	bool startRecording(const std::string &fileName, cv::Size &fsize);
+	// Encode the given contrast image and queue it for writing. Images that do not have the size
+	// of the recording, that arrive while the queue is full, or that cannot be written because
+	// an earlier write failed are counted as dropped.
+	void recordFrame(cv::InputArray input, double timestamp);
+	// Stop recording after all queued frames have been written.
+	void stopRecording();
+	// Is a recording in progress?
+	bool isRecording();
+
+protected:
+	void run();
+
+private:
+	FILE *file;
+	cv::Size fsize;
+	Mutex queueMutex;
+	Condition queueCondition;
+	std::deque<std::vector<unsigned char> *> queue;
+	std::vector<std::vector<unsigned char> *> freeBuffers;
+	std::vector<RleFrameIndexEntry> index;
+	// The end of the frame data, where the index is written
+	long long indexOffset;
+	bool stopRequested;
+	int droppedFrames;
+	// Set when writing to the file failed, later frames are dropped
+	bool writeFailed;
+};
+
+// Reads contrast images from files written by ThresholdRecorder.
+class ThresholdPlayer {
+public:
+	ThresholdPlayer();
+	~ThresholdPlayer();
+
+	// Open the given file. Returns false if it is not a valid recording. The frames are found by
+	// scanning the file if its index is missing or inconsistent.
+	bool open(const std::string &fileName);
+	// Close the current file.
+	void close();
+	// The size of the recorded contrast images.
+	cv::Size frameSize();
+	// The number of recorded frames.
+	int frameCount();
+	// Continue reading at the given frame number.
+	bool seekFrame(int frame);
+	// Decode the next frame into a binary image with the values 0 and 255. Returns false
+	// if the end of the file has been reached.
+	bool readFrame(cv::OutputArray output, double &timestamp);
+
+private:
+	FILE *file;
+	long long fileSize;
+	cv::Size fsize;
+	std::vector<RleFrameIndexEntry> index;
+	std::vector<unsigned char> buffer;
+	int nextFrame;
+
+	bool readIndex();
+	void scanFrames();
+};
+
+// Does the given file name denote a run-length encoded recording?
+bool isRleFileName(const std::string &fileName);
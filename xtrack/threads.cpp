@@ -0,0 +1,101 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Threading primitives with a platform dependent implementation
+
+#include <windows.h>
+#include <process.h>
+#include "threads.h"
+
+Mutex::Mutex() {
+	CRITICAL_SECTION *section = new CRITICAL_SECTION;
+	InitializeCriticalSection(section);
+	this->handle = section;
+}
+
+Mutex::~Mutex() {
+	CRITICAL_SECTION *section = (CRITICAL_SECTION *) handle;
+	DeleteCriticalSection(section);
+	delete section;
+}
+
+void Mutex::lock() {
+	EnterCriticalSection((CRITICAL_SECTION *) handle);
+}
+
+bool Mutex::tryLock() {
+	return TryEnterCriticalSection((CRITICAL_SECTION *) handle) != 0;
+}
+
+void Mutex::unlock() {
+	LeaveCriticalSection((CRITICAL_SECTION *) handle);
+}
+
+Condition::Condition() {
+	CONDITION_VARIABLE *condition = new CONDITION_VARIABLE;
+	InitializeConditionVariable(condition);
+	this->handle = condition;
+}
+
+Condition::~Condition() {
+	delete (CONDITION_VARIABLE *) handle;
+}
+
+void Condition::wait(Mutex &mutex, int timeout) {
+	SleepConditionVariableCS((CONDITION_VARIABLE *) handle, (CRITICAL_SECTION *) mutex.handle,
+		timeout < 0 ? INFINITE : (DWORD) timeout);
+}
+
+void Condition::notifyAll() {
+	WakeAllConditionVariable((CONDITION_VARIABLE *) handle);
+}
+
+struct ThreadEntry {
+	static unsigned __stdcall execute(void *thread) {
+		if (Thread::defaultCore >= 0) {
+			SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR) 1 << Thread::defaultCore);
+		}
+		((Thread *) thread)->run();
+		return 0;
+	}
+};
+
+int Thread::defaultCore = -1;
+
+Thread::Thread() {
+	this->handle = NULL;
+}
+
+Thread::~Thread() {
+	join();
+}
+
+bool Thread::start() {
+	if (handle != NULL) {
+		return false;
+	}
+	uintptr_t result = _beginthreadex(NULL, 0, ThreadEntry::execute, this, 0, NULL);
+	if (result == 0) {
+		std::cerr << "Thread cannot be started\n";
+		return false;
+	}
+	handle = (void *) result;
+	return true;
+}
+
+void Thread::join() {
+	if (handle != NULL) {
+		WaitForSingleObject((HANDLE) handle, INFINITE);
+		CloseHandle((HANDLE) handle);
+		handle = NULL;
+	}
+}
+
+void Thread::setDefaultCore(int core) {
+	defaultCore = core;
+}
@@ -0,0 +1,80 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Measuring the processing time of the individual pipeline stages
+
+#include "timing.h"
+
+static const char *STAGE_NAMES[STAGE_COUNT] = {
+	"capture", "preprocess", "tracking", "output", "display"
+};
+
+StageTimer::StageTimer() {
+	this->tickPeriod = 1000.0 / cv::getTickFrequency();
+	this->firstTick = 0;
+	this->lastTick = 0;
+	this->frames = 0;
+	for (int i = 0; i < STAGE_COUNT; i++) {
+		lastTimes[i] = 0.0;
+		totalTimes[i] = 0.0;
+		maxTimes[i] = 0.0;
+	}
+}
+
+void StageTimer::startFrame() {
+	lastTick = cv::getTickCount();
+	if (frames == 0) {
+		firstTick = lastTick;
+	}
+	frames++;
+	for (int i = 0; i < STAGE_COUNT; i++) {
+		lastTimes[i] = 0.0;
+	}
+}
+
+void StageTimer::endStage(ProcessingStage stage) {
+	int64 tick = cv::getTickCount();
+	double time = (tick - lastTick) * tickPeriod;
+	lastTick = tick;
+	lastTimes[stage] += time;
+	totalTimes[stage] += time;
+	if (lastTimes[stage] > maxTimes[stage]) {
+		maxTimes[stage] = lastTimes[stage];
+	}
+}
+
+double StageTimer::lastTime(ProcessingStage stage) {
+	return lastTimes[stage];
+}
+
+int StageTimer::frameCount() {
+	return frames;
+}
+
+void StageTimer::printSummary() {
+	if (frames == 0) {
+		return;
+	}
+	double wallTime = (lastTick - firstTick) * tickPeriod;
+	double busyTime = 0.0;
+	std::cout << "Processed " << frames << " frames in " << (int) (wallTime + 0.5) << " ms";
+	if (wallTime > 0) {
+		std::cout << " (" << (int) (1000.0 * frames / wallTime + 0.5) << " fps)";
+	}
+	std::cout << "\n";
+	std::streamsize oldPrecision = std::cout.precision(3);
+	std::cout << std::fixed;
+	for (int i = 0; i < STAGE_COUNT; i++) {
+		std::cout << "  " << STAGE_NAMES[i] << ": avg " << totalTimes[i] / frames
+			<< " ms, max " << maxTimes[i] << " ms\n";
+		busyTime += totalTimes[i];
+	}
+	std::cout << "  total: avg " << busyTime / frames << " ms\n";
+	std::cout.unsetf(std::ios::fixed);
+	std::cout.precision(oldPrecision);
+}
@@ -13,17 +13,29 @@
 #include "stdafx.h"
 #include "fiducials.h"
 
+class WOscBundle;
+
 class TuioServer {
 public:
 	TuioServer(std::unordered_map<std::string, std::string> &parameters);
 	~TuioServer();
 
-	// Send a TUIO message containing tracking information for the given fiducials.
-	void sendMessage(TrackedFiducial fiducials[]);
+	// Send a TUIO message containing tracking information for the given fiducials. If the
+	// information has been predicted instead of measured, the bundle contains an additional
+	// "pred" message listing the session ids of the predicted fiducials.
+	void sendMessage(TrackedFiducial fiducials[], bool predicted = false);
+	// Send a TUIO message of the blob profile containing the given blobs. The blobs are sent in a
+	// bundle of their own, with their own frame sequence.
+	void sendBlobs(const std::vector<TrackedBlob> &blobs);
 
 private:
 	std::string ipaddr;
 	unsigned short port;
 	int fseq;
 	int sock;
+	// The OSC address of the blob messages, /tuio/2Dblb or /tuio/2Dcur
+	std::string blobPath;
+	int blobSeq;
+
+	void sendBundle(WOscBundle &bundle);
 };
@@ -0,0 +1,131 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Sending TUIO messages at a higher rate than the camera frame rate
+
+#include <algorithm>
+#include <cmath>
+#include "upsampling.h"
+
+// The weight of a new speed measurement in the smoothed speed
+static const float SPEED_SMOOTHING = 0.5f;
+// Fiducials are not moved further than their position after this time (in seconds) without a new frame
+static const double MAX_PREDICTION_TIME = 0.1;
+
+static bool isValid(float f) {
+	return f == f;
+}
+
+static float smooth(float smoothed, float speed, bool reset) {
+	if (!isValid(speed)) {
+		return reset ? speed : smoothed;
+	}
+	if (reset || !isValid(smoothed)) {
+		return speed;
+	}
+	return smoothed + SPEED_SMOOTHING * (speed - smoothed);
+}
+
+TuioUpsampler::TuioUpsampler(TuioServer &tuioServer, int rate) : tuioServer(tuioServer) {
+	this->tickPeriod = 1000.0 / cv::getTickFrequency();
+	this->periodTicks = (int64) (cv::getTickFrequency() / rate);
+	this->stopRequested = false;
+	this->frameAvailable = false;
+	this->frameSent = false;
+	this->measureTick = 0;
+	for (int i = 0; i < MAX_FIDUCIALS; i++) {
+		measured[i].isTracked = false;
+	}
+	start();
+}
+
+TuioUpsampler::~TuioUpsampler() {
+	{
+		MutexLock lock(mutex);
+		stopRequested = true;
+		condition.notifyAll();
+	}
+	join();
+}
+
+void TuioUpsampler::update(TrackedFiducial fiducials[]) {
+	MutexLock lock(mutex);
+	for (int i = 0; i < MAX_FIDUCIALS; i++) {
+		// Smooth the speeds, starting anew when the fiducial has just appeared
+		TrackedFiducial previous = measured[i];
+		bool reset = !previous.isTracked;
+		TrackedFiducial &fid = measured[i];
+		fid = fiducials[i];
+		output[i] = fiducials[i];
+		if (fid.isTracked) {
+			fid.xspeed = smooth(previous.xspeed, fiducials[i].xspeed, reset);
+			fid.yspeed = smooth(previous.yspeed, fiducials[i].yspeed, reset);
+			fid.aspeed = smooth(previous.aspeed, fiducials[i].aspeed, reset);
+		}
+	}
+	measureTick = cv::getTickCount();
+	frameAvailable = true;
+	frameSent = false;
+	condition.notifyAll();
+}
+
+void TuioUpsampler::run() {
+	mutex.lock();
+	int64 nextTick = cv::getTickCount();
+	while (!stopRequested) {
+		int64 now = cv::getTickCount();
+		if (frameSent && now < nextTick) {
+			condition.wait(mutex, (int) ceil((nextTick - now) * tickPeriod));
+			continue;
+		}
+		if (!frameAvailable) {
+			// Nothing to send before the first frame
+			condition.wait(mutex);
+			continue;
+		}
+
+		bool predicted = frameSent;
+		if (predicted) {
+			predict(std::min((now - measureTick) * tickPeriod / 1000, MAX_PREDICTION_TIME));
+		}
+		frameSent = true;
+		// Predictions follow a fixed schedule, which restarts with each new frame
+		nextTick = predicted && nextTick + periodTicks > now ? nextTick + periodTicks : now + periodTicks;
+
+		// Send without holding the lock so that new frames are not delayed
+		TrackedFiducial message[MAX_FIDUCIALS];
+		for (int i = 0; i < MAX_FIDUCIALS; i++) {
+			message[i] = output[i];
+		}
+		mutex.unlock();
+		tuioServer.sendMessage(message, predicted);
+		mutex.lock();
+	}
+	mutex.unlock();
+}
+
+void TuioUpsampler::predict(double time) {
+	for (int i = 0; i < MAX_FIDUCIALS; i++) {
+		TrackedFiducial &fid = measured[i];
+		TrackedFiducial &out = output[i];
+		out = fid;
+		if (!fid.isTracked) {
+			continue;
+		}
+		if (isValid(fid.xspeed) && isValid(fid.yspeed)) {
+			out.x = std::max(0.0f, std::min(1.0f, (float) (fid.x + fid.xspeed * time)));
+			out.y = std::max(0.0f, std::min(1.0f, (float) (fid.y + fid.yspeed * time)));
+		}
+		if (isValid(fid.aspeed)) {
+			out.a = (float) fmod(fid.a + fid.aspeed * time, 2 * PI);
+			if (out.a < 0) {
+				out.a += 2 * PI;
+			}
+		}
+	}
+}
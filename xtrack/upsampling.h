@@ -0,0 +1,49 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Sending TUIO messages at a higher rate than the camera frame rate
+
+#pragma once
+
+#include "stdafx.h"
+#include "fiducials.h"
+#include "tuio.h"
+#include "threads.h"
+
+// Sends TUIO messages at a fixed rate from a separate thread. The tracking information of
+// each frame is sent as soon as it is available; between frames, the fiducials are moved
+// according to their smoothed speeds and the messages are marked as predicted.
+class TuioUpsampler : private Thread {
+public:
+	// Messages are sent with the given rate (in Hertz) through the given server.
+	TuioUpsampler(TuioServer &tuioServer, int rate);
+	~TuioUpsampler();
+
+	// Pass the tracking information of a new frame.
+	void update(TrackedFiducial fiducials[]);
+
+protected:
+	void run();
+
+private:
+	TuioServer &tuioServer;
+	double tickPeriod;
+	int64 periodTicks;
+	Mutex mutex;
+	Condition condition;
+	bool stopRequested;
+	bool frameAvailable;
+	bool frameSent;
+	// The last measured fiducials with smoothed speeds, and the time of their measurement
+	TrackedFiducial measured[MAX_FIDUCIALS];
+	int64 measureTick;
+	// The information sent in the next message
+	TrackedFiducial output[MAX_FIDUCIALS];
+
+	void predict(double time);
+};
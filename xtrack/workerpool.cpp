@@ -0,0 +1,100 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Processing independent parts of a task on several threads
+
+#include <sstream>
+#include "workerpool.h"
+#include "realtime.h"
+
+WorkerPool::WorkerPool(int threads, int firstCore, int priority) {
+	this->stopRequested = false;
+	this->generation = 0;
+	this->task = NULL;
+	this->nextPart = 0;
+	this->partCount = 0;
+	this->remainingParts = 0;
+	for (int i = 0; i < threads; i++) {
+		Worker *worker = new Worker(*this, i, firstCore >= 0 ? firstCore + i : -1, priority);
+		if (!worker->start()) {
+			delete worker;
+			std::cerr << "Could not start worker thread " << i << "\n";
+			throw 1;
+		}
+		workers.push_back(worker);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		MutexLock lock(mutex);
+		stopRequested = true;
+		started.notifyAll();
+	}
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i]->join();
+		delete workers[i];
+	}
+}
+
+void WorkerPool::run(ParallelTask &task, int count) {
+	MutexLock lock(mutex);
+	this->task = &task;
+	nextPart = 0;
+	partCount = count;
+	remainingParts = count;
+	generation++;
+	started.notifyAll();
+
+	processParts();
+	while (remainingParts > 0) {
+		finished.wait(mutex);
+	}
+	this->task = NULL;
+}
+
+int WorkerPool::threadCount() {
+	return (int) workers.size();
+}
+
+void WorkerPool::Worker::run() {
+	std::ostringstream name;
+	name << "Fiducial worker " << index;
+	configureCurrentThread(name.str(), core, priority);
+	pool.work();
+}
+
+void WorkerPool::work() {
+	int seenGeneration = 0;
+	MutexLock lock(mutex);
+	while (true) {
+		while (!stopRequested && generation == seenGeneration) {
+			started.wait(mutex);
+		}
+		if (stopRequested) {
+			return;
+		}
+		seenGeneration = generation;
+		processParts();
+	}
+}
+
+// Take parts of the current task until none are left. The mutex must be held, it is released
+// while a part is processed.
+void WorkerPool::processParts() {
+	while (nextPart < partCount) {
+		int part = nextPart++;
+		ParallelTask *current = task;
+		mutex.unlock();
+		current->runPart(part);
+		mutex.lock();
+		if (--remainingParts == 0) {
+			finished.notifyAll();
+		}
+	}
+}
@@ -0,0 +1,69 @@
+/*******************************************************************************
+ * Copyright (c) 2014 itemis AG (http://www.itemis.eu) and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+// Processing independent parts of a task on several threads
+
+#pragma once
+
+#include "stdafx.h"
+#include "threads.h"
+
+// A task that consists of independent parts, which may be processed in any order and in parallel.
+class ParallelTask {
+public:
+	virtual ~ParallelTask() {}
+
+	// Process the part with the given index.
+	virtual void runPart(int part) = 0;
+};
+
+// A fixed set of worker threads that is reused for all tasks. The thread calling 'run' processes
+// parts of the task as well, so a pool without workers processes the task serially.
+class WorkerPool {
+public:
+	// Start the given number of worker threads. Worker i is pinned to core firstCore + i unless
+	// firstCore is negative, and runs with the given real-time priority unless it is 0.
+	WorkerPool(int threads, int firstCore, int priority);
+	~WorkerPool();
+
+	// Process the parts 0 to count - 1 of the task and return when all parts are done.
+	void run(ParallelTask &task, int count);
+	// The number of worker threads, not counting the calling thread.
+	int threadCount();
+
+private:
+	class Worker : public Thread {
+	public:
+		Worker(WorkerPool &pool, int index, int core, int priority)
+			: pool(pool), index(index), core(core), priority(priority) {}
+	protected:
+		void run();
+	private:
+		WorkerPool &pool;
+		int index;
+		int core;
+		int priority;
+	};
+
+	std::vector<Worker *> workers;
+	Mutex mutex;
+	// Notified when a new task is available or the pool is stopped
+	Condition started;
+	// Notified when the last part of a task is done
+	Condition finished;
+	bool stopRequested;
+	// Incremented for each task, so that workers recognize new tasks
+	int generation;
+	ParallelTask *task;
+	int nextPart;
+	int partCount;
+	int remainingParts;
+
+	void work();
+	void processParts();
+};